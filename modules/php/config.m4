@@ -9,8 +9,17 @@ PHP_ADD_INCLUDE($LIB_PATH/../unicode-table/src)
 SOURCES=" \
 	json5.c \
 	$LIB_PATH/json5-coder.c \
+	$LIB_PATH/json5-coder-pool.c \
+	$LIB_PATH/json5-document.c \
+	$LIB_PATH/json5-hash.c \
+	$LIB_PATH/json5-matcher.c \
+	$LIB_PATH/json5-parallel.c \
 	$LIB_PATH/json5-parser.c \
+	$LIB_PATH/json5-pipeline.c \
+	$LIB_PATH/json5-reader.c \
+	$LIB_PATH/json5-thread-pool.c \
 	$LIB_PATH/json5-tokenizer.c \
+	$LIB_PATH/json5-validator.c \
 	$LIB_PATH/json5-value.c \
 	$LIB_PATH/json5-writer.c \
 	$LIB_PATH/../unicode-table/src/unicode-table.c"
@@ -10,6 +10,8 @@
 #define PHP_JSON5_EXTNAME "json5"
 
 #define PHP_JSON5_STACK_INIT_SIZE 16
+#define PHP_JSON5_POOL_SIZE 16
+#define PHP_JSON5_POOL_MAX_BUFFER (64 * 1024)
 
 enum {
 	JSON5_FLAGS_ASSOC = 1 << 0,
@@ -29,8 +31,10 @@ extern zend_module_entry json5_module_entry;
 static double double_pos_inf;
 static double double_neg_inf;
 static double double_nan;
+static json5_coder_pool coder_pool;
 
 PHP_MINIT_FUNCTION(json5);
+PHP_MSHUTDOWN_FUNCTION(json5);
 PHP_FUNCTION(json5_decode);
 PHP_FUNCTION(json5_encode);
 
@@ -50,7 +54,7 @@ zend_module_entry json5_module_entry = {
 	PHP_JSON5_EXTNAME,
 	json5_functions,
 	PHP_MINIT(json5), // name of the MINIT function or NULL if not applicable
-	NULL, // name of the MSHUTDOWN function or NULL if not applicable
+	PHP_MSHUTDOWN(json5), // name of the MSHUTDOWN function or NULL if not applicable
 	NULL, // name of the RINIT function or NULL if not applicable
 	NULL, // name of the RSHUTDOWN function or NULL if not applicable
 	NULL, // name of the MINFO function or NULL if not applicable
@@ -79,6 +83,17 @@ PHP_MINIT_FUNCTION(json5)
 
 	json5_set_hash_seed(seed);
 
+	if (json5_coder_pool_init(&coder_pool, PHP_JSON5_POOL_SIZE, PHP_JSON5_POOL_MAX_BUFFER) != 0) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+PHP_MSHUTDOWN_FUNCTION(json5)
+{
+	json5_coder_pool_destroy(&coder_pool);
+
 	return SUCCESS;
 }
 
@@ -324,7 +339,7 @@ static int coder_handle_error(json5_coder *coder) {
 	}
 
 	if (error_val) {
-		php_error_docref("function." FUNCTION_NAME TSRMLS_CC, E_WARNING, (char *) error_val->sval);
+		php_error_docref("function." FUNCTION_NAME TSRMLS_CC, E_WARNING, (char *) json5_value_get_string(error_val));
 		return 1;
 	}
 
@@ -338,7 +353,7 @@ PHP_FUNCTION(json5_decode)
 	zend_bool assoc;
 	zval recursion;
 	zval options;
-	json5_coder coder;
+	json5_coder *coder;
 	json5_value value;
 	struct _json5_item *top;
 	size_t flags = 0;
@@ -359,9 +374,12 @@ PHP_FUNCTION(json5_decode)
 		}
 	}
 
-	if (json5_coder_init(&coder) != 0) {
+	value = JSON5_VALUE_INIT;
+	memset(&stack, 0, sizeof(stack));
+
+	if (!(coder = json5_coder_pool_get(&coder_pool))) {
 		php_error_docref("function." FUNCTION_NAME TSRMLS_CC, E_ERROR, "Allocation error");
-		goto error;
+		RETURN_NULL();
 	}
 
 	if (_json5_stack_init(&stack, flags) != 0) {
@@ -369,23 +387,28 @@ PHP_FUNCTION(json5_decode)
 		goto error;
 	}
 
-	coder.parser.funcs = &funcs;
-	coder.parser.funcs_arg = &stack;
+	coder->parser.funcs = &funcs;
+	coder->parser.funcs_arg = &stack;
+
+	if (Z_LVAL(recursion) > 0) {
+		json5_limits limits = {0};
+
+		limits.max_depth = Z_LVAL(recursion);
+		json5_coder_set_limits(coder, &limits);
+	}
 
 	top = _json5_stack_push(&stack); // root
 	top->value = return_value;
 
-	value = JSON5_VALUE_INIT;
-
-	res = json5_coder_decode(&coder, (uint8_t *) string->val, string->len, &value);
+	res = json5_coder_decode(coder, (uint8_t *) string->val, string->len, &value);
 
 	if (res != 0) {
-		if (coder_handle_error(&coder)) {
+		if (coder_handle_error(coder)) {
 			goto error;
 		}
 	}
 
-	json5_coder_destroy(&coder);
+	json5_coder_pool_put(&coder_pool, coder);
 
 	json5_value_set_null(&value);
 	_json5_stack_destroy(&stack);
@@ -393,7 +416,7 @@ PHP_FUNCTION(json5_decode)
 	return;
 
 	error: {
-		json5_coder_destroy(&coder);
+		json5_coder_pool_put(&coder_pool, coder);
 		json5_value_set_null(&value);
 		_json5_stack_destroy(&stack);
 
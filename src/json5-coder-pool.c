@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "json5-coder-pool.h"
+
+int json5_coder_pool_init (json5_coder_pool * pool, size_t max_coders, size_t max_size) {
+	memset (pool, 0, sizeof (*pool));
+
+	if (max_coders && !(pool -> coders = malloc (max_coders * sizeof (*pool -> coders)))) {
+		return -1;
+	}
+
+	if (pthread_mutex_init (&pool -> lock, NULL) != 0) {
+		free (pool -> coders);
+		return -1;
+	}
+
+	pool -> cap = max_coders;
+	pool -> max_size = max_size;
+
+	return 0;
+}
+
+void json5_coder_pool_destroy (json5_coder_pool * pool) {
+	for (size_t i = 0; i < pool -> len; i ++) {
+		json5_coder_destroy (pool -> coders [i]);
+		free (pool -> coders [i]);
+	}
+
+	pthread_mutex_destroy (&pool -> lock);
+	free (pool -> coders);
+
+	memset (pool, 0, sizeof (*pool));
+}
+
+json5_coder * json5_coder_pool_get (json5_coder_pool * pool) {
+	json5_coder * coder = NULL;
+
+	pthread_mutex_lock (&pool -> lock);
+
+	if (pool -> len) {
+		coder = pool -> coders [-- pool -> len];
+		pool -> stats.hits ++;
+	}
+	else {
+		pool -> stats.misses ++;
+	}
+
+	pthread_mutex_unlock (&pool -> lock);
+
+	if (coder) {
+		return coder;
+	}
+
+	if (!(coder = malloc (sizeof (*coder)))) {
+		return NULL;
+	}
+
+	if (json5_coder_init (coder) != 0) {
+		free (coder);
+		return NULL;
+	}
+
+	return coder;
+}
+
+void json5_coder_pool_put (json5_coder_pool * pool, json5_coder * coder) {
+	int trimmed;
+
+	coder -> parser.funcs = NULL;
+	coder -> parser.funcs_arg = NULL;
+	json5_coder_set_limits (coder, NULL);
+	json5_coder_set_dup_policy (coder, JSON5_DUP_LAST);
+	json5_coder_set_keyset (coder, NULL);
+	json5_coder_reset (coder);
+	trimmed = json5_coder_trim (coder, pool -> max_size);
+
+	pthread_mutex_lock (&pool -> lock);
+
+	if (trimmed) {
+		pool -> stats.trims ++;
+	}
+
+	if (pool -> len < pool -> cap) {
+		pool -> coders [pool -> len ++] = coder;
+		coder = NULL;
+	}
+	else {
+		pool -> stats.drops ++;
+	}
+
+	pthread_mutex_unlock (&pool -> lock);
+
+	if (coder) {
+		json5_coder_destroy (coder);
+		free (coder);
+	}
+}
+
+void json5_coder_pool_get_stats (json5_coder_pool * pool, json5_coder_pool_stats * out_stats) {
+	pthread_mutex_lock (&pool -> lock);
+	*out_stats = pool -> stats;
+	pthread_mutex_unlock (&pool -> lock);
+}
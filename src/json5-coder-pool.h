@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+
+/**
+ * Defines coder pool statistics.
+ */
+typedef struct {
+	size_t hits;   ///< Number of coders taken from the pool.
+	size_t misses; ///< Number of coders created because the pool was empty.
+	size_t trims;  ///< Number of returned coders whose buffers were shrunk.
+	size_t drops;  ///< Number of returned coders destroyed because the pool was full.
+} json5_coder_pool_stats;
+
+/**
+ * A thread-safe pool of reusable coders.
+ */
+typedef struct {
+	json5_coder ** coders;        ///< Idle coders.
+	size_t len;                   ///< Number of idle coders.
+	size_t cap;                   ///< Maximum number of idle coders.
+	size_t max_size;              ///< Maximum buffer size of idle coders in bytes.
+	pthread_mutex_t lock;         ///< Protects the pool.
+	json5_coder_pool_stats stats; ///< The pool statistics.
+} json5_coder_pool;
+
+/**
+ * Initialize a coder pool.
+ *
+ * @param pool The pool to initialize.
+ * @param max_coders The maximum number of idle coders kept in the pool.
+ * @param max_size The maximum size of the tokenizer buffer and parser stack
+ * of idle coders in bytes. Larger buffers are shrunk to their initial size
+ * when a coder is returned.
+ *
+ * @return 0 on success or -1 if an error occurred.
+ */
+extern int json5_coder_pool_init (json5_coder_pool * pool, size_t max_coders, size_t max_size);
+
+/**
+ * Destroy a coder pool and all idle coders.
+ *
+ * Coders not yet returned have to be destroyed by the user.
+ *
+ * @param pool The pool to destroy.
+ */
+extern void json5_coder_pool_destroy (json5_coder_pool * pool);
+
+/**
+ * Take a reset coder from the pool or create a new one if the pool is empty.
+ *
+ * @param pool The pool.
+ *
+ * @return The coder or NULL if an allocation error occurred.
+ */
+extern json5_coder * json5_coder_pool_get (json5_coder_pool * pool);
+
+/**
+ * Return a coder to the pool.
+ *
+ * The coder is reset and its parser callback functions, limits, duplicate
+ * key policy and key set are cleared. If the pool is full, the coder is
+ * destroyed.
+ *
+ * @param pool The pool.
+ * @param coder The coder taken with `json5_coder_pool_get`.
+ */
+extern void json5_coder_pool_put (json5_coder_pool * pool, json5_coder * coder);
+
+/**
+ * Get the pool statistics.
+ *
+ * @param pool The pool.
+ * @param out_stats The statistics.
+ */
+extern void json5_coder_pool_get_stats (json5_coder_pool * pool, json5_coder_pool_stats * out_stats);
@@ -22,14 +22,24 @@
  */
 
 #include <string.h>
+#include <time.h>
 #include "json5-coder.h"
 
+/**
+ * Number of bytes scanned between checking the time budget
+ */
+#define TIME_SLICE_SIZE 4096
+
 /**
  * Initialize a coder object
  */
 int json5_coder_init (json5_coder * coder) {
 	int res = 0;
 
+	coder -> value_func = NULL;
+	coder -> value_arg = NULL;
+	coder -> doc_open = 0;
+
 	if ((res = json5_tokenizer_init (&coder -> tknzr)) != 0) {
 		goto cleanup;
 	}
@@ -52,26 +62,58 @@ void json5_coder_destroy (json5_coder * coder) {
 	json5_parser_destroy (&coder -> parser);
 }
 
-static void json5_coder_reset (json5_coder * coder) {
+void json5_coder_reset (json5_coder * coder) {
 	json5_tokenizer_reset (&coder -> tknzr);
 	json5_parser_reset (&coder -> parser);
+	json5_parser_set_item_func (&coder -> parser, 0, NULL, NULL);
+	coder -> doc_open = 0;
+}
+
+int json5_coder_trim (json5_coder * coder, size_t max_size) {
+	int res = 0;
+
+	res |= json5_tokenizer_trim (&coder -> tknzr, max_size);
+	res |= json5_parser_trim (&coder -> parser, max_size);
+
+	return res;
 }
 
 static int json5_coder_put_token (json5_token const * token, json5_coder * coder) {
 	return json5_parser_put_tokens (&coder -> parser, token, 1);
 }
 
+void json5_coder_set_limits (json5_coder * coder, json5_limits const * limits) {
+	json5_tokenizer_set_max_length (&coder -> tknzr, limits ? limits -> max_string_len : 0);
+	json5_parser_set_limits (&coder -> parser, limits);
+}
+
+void json5_coder_set_dup_policy (json5_coder * coder, json5_dup_policy policy) {
+	json5_parser_set_dup_policy (&coder -> parser, policy);
+}
+
+void json5_coder_set_keyset (json5_coder * coder, json5_keyset const * keyset) {
+	json5_parser_set_keyset (&coder -> parser, keyset);
+}
+
 int json5_coder_decode (json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_value) {
 	int res;
 
 	json5_coder_reset (coder);
 
-	if ((res = json5_tokenizer_put_chars (&coder -> tknzr, string, size, (json5_put_token_func) json5_coder_put_token, coder)) != 0) {
-		return res;
+	// build value tree directly if no parser callbacks are set
+	if (!coder -> parser.funcs) {
+		if ((res = json5_parser_decode (&coder -> parser, &coder -> tknzr, string, size)) != 0) {
+			return res;
+		}
 	}
+	else {
+		if ((res = json5_tokenizer_put_chars (&coder -> tknzr, string, size, (json5_put_token_func) json5_coder_put_token, coder)) != 0) {
+			return res;
+		}
 
-	if ((res = json5_tokenizer_put_chars (&coder -> tknzr, NULL, 0, (json5_put_token_func) json5_coder_put_token, coder)) != 0) {
-		return res;
+		if ((res = json5_tokenizer_put_chars (&coder -> tknzr, NULL, 0, (json5_put_token_func) json5_coder_put_token, coder)) != 0) {
+			return res;
+		}
 	}
 
 	json5_value_set_null (out_value);
@@ -80,3 +122,140 @@ int json5_coder_decode (json5_coder * coder, uint8_t const * string, size_t size
 
 	return res;
 }
+
+int json5_coder_decode_into (json5_coder * coder, uint8_t const * string, size_t size, json5_value * value) {
+	json5_coder_reset (coder);
+
+	return json5_parser_decode_into (&coder -> parser, &coder -> tknzr, string, size, value);
+}
+
+static uint64_t json5_coder_time (void) {
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int json5_coder_decode_step (json5_coder * coder, uint8_t const ** chars, uint8_t const * end, int final, json5_coder_budget const * budget) {
+	ssize_t count;
+	size_t size;
+	size_t max_bytes = SIZE_MAX;
+	size_t max_tokens = SIZE_MAX;
+	uint64_t deadline = 0;
+	uint8_t const * start;
+	uint8_t const * slice_end;
+	json5_parser * parser = &coder -> parser;
+
+	if (json5_parser_is_finished (parser)) {
+		return json5_parser_has_error (parser) ? -1 : 0;
+	}
+
+	if (budget) {
+		if (budget -> max_bytes) {
+			max_bytes = budget -> max_bytes;
+		}
+
+		if (budget -> max_tokens) {
+			max_tokens = budget -> max_tokens;
+		}
+
+		if (budget -> max_ns) {
+			deadline = json5_coder_time () + budget -> max_ns;
+		}
+	}
+
+	for (;;) {
+		size = end - *chars;
+
+		if (size > max_bytes) {
+			size = max_bytes;
+		}
+
+		if (deadline && size > TIME_SLICE_SIZE) {
+			size = TIME_SLICE_SIZE;
+		}
+
+		start = *chars;
+		slice_end = &start [size];
+
+		if ((count = json5_parser_decode_tokens (parser, &coder -> tknzr, chars, slice_end, final && slice_end == end, max_tokens)) < 0) {
+			return -1;
+		}
+
+		max_bytes -= *chars - start;
+		max_tokens -= count;
+
+		// all characters consumed and end of input parsed if final
+		if (*chars >= end && (!final || json5_parser_is_finished (parser))) {
+			return 0;
+		}
+
+		if (!max_bytes || !max_tokens || (deadline && json5_coder_time () >= deadline)) {
+			return JSON5_CODER_CONTINUE;
+		}
+	}
+}
+
+int json5_coder_take_value (json5_coder * coder, json5_value * out_value) {
+	json5_parser * parser = &coder -> parser;
+
+	if (!json5_parser_is_finished (parser) || json5_parser_has_error (parser)) {
+		return -1;
+	}
+
+	json5_value_set_null (out_value);
+	*out_value = parser -> value;
+	memset (&parser -> value, 0, sizeof (parser -> value));
+
+	return 0;
+}
+
+static int json5_coder_put_doc_token (json5_token const * token, json5_coder * coder) {
+	int res;
+	json5_parser * parser = &coder -> parser;
+
+	// end of input between documents
+	if (token -> type == JSON5_TOK_END && !coder -> doc_open) {
+		return 0;
+	}
+
+	if ((res = json5_parser_put_tokens (parser, token, 1)) != 0) {
+		return res;
+	}
+
+	coder -> doc_open = 1;
+
+	if (json5_parser_root_complete (parser)) {
+		res = coder -> value_func (&parser -> value, coder -> value_arg);
+
+		// keep stack and tokenizer state
+		json5_parser_reset (parser);
+		coder -> doc_open = 0;
+	}
+
+	return res;
+}
+
+int json5_coder_put_docs (json5_coder * coder, uint8_t const * chars, size_t size, json5_coder_value_func func, void * arg) {
+	coder -> value_func = func;
+	coder -> value_arg = arg;
+
+	return json5_tokenizer_put_chars (&coder -> tknzr, chars, size, (json5_put_token_func) json5_coder_put_doc_token, coder);
+}
+
+int json5_coder_put_items (json5_coder * coder, uint8_t const * chars, size_t size, size_t depth, json5_coder_value_func func, void * arg) {
+	json5_parser_set_item_func (&coder -> parser, depth, func, arg);
+
+	return json5_tokenizer_put_chars (&coder -> tknzr, chars, size, (json5_put_token_func) json5_coder_put_token, coder);
+}
+
+char const * json5_coder_get_error (json5_coder const * coder) {
+	json5_value const * error = json5_parser_get_error (&coder -> parser);
+
+	if (error && error -> type == JSON5_TYPE_STRING) {
+		return (char const *) json5_value_get_string (error);
+	}
+
+	return json5_tokenizer_get_error (&coder -> tknzr);
+}
@@ -25,9 +25,34 @@
 
 #include "json5-parser.h"
 
+/**
+ * Returned by `json5_coder_decode_step` if the budget is exhausted before all
+ * characters are consumed.
+ */
+#define JSON5_CODER_CONTINUE 1
+
+/**
+ * A callback function receiving decoded values.
+ */
+typedef json5_parser_value_func json5_coder_value_func;
+
+/**
+ * Defines the work done by a single call of `json5_coder_decode_step`.
+ *
+ * A limit of 0 means no limit.
+ */
+typedef struct {
+	size_t max_bytes;  ///< Maximum number of bytes to consume.
+	size_t max_tokens; ///< Maximum number of tokens to parse.
+	uint64_t max_ns;   ///< Maximum time to spend in nanoseconds.
+} json5_coder_budget;
+
 typedef struct {
 	json5_tokenizer tknzr;
 	json5_parser parser;
+	json5_coder_value_func value_func;
+	void * value_arg;
+	int doc_open;
 } json5_coder;
 
 /**
@@ -40,7 +65,117 @@ extern int json5_coder_init (json5_coder * coder);
  */
 extern void json5_coder_destroy (json5_coder * coder);
 
+/**
+ * Reset a coder object
+ *
+ * Has to be called before decoding a new stream with `json5_coder_put_docs`.
+ */
+extern void json5_coder_reset (json5_coder * coder);
+
+/**
+ * Shrink the tokenizer buffer and parser stack to their initial sizes if they
+ * are larger than @p max_size bytes
+ *
+ * Returns 1 if any memory was released or 0 otherwise.
+ */
+extern int json5_coder_trim (json5_coder * coder, size_t max_size);
+
+/**
+ * Set limits for decoding untrusted input
+ *
+ * Decoding fails with an error as soon as a limit is exceeded. Overlong
+ * strings are rejected before they are buffered completely. Pass `NULL` to
+ * remove all limits. The limits are kept when the coder is reset.
+ */
+extern void json5_coder_set_limits (json5_coder * coder, json5_limits const * limits);
+
+/**
+ * Set how repeated object keys are handled
+ *
+ * With `JSON5_DUP_LAST` the existing key storage is reused for the new value.
+ * With `JSON5_DUP_FIRST` later values are validated but not built. The
+ * policy is kept when the coder is reset.
+ */
+extern void json5_coder_set_dup_policy (json5_coder * coder, json5_dup_policy policy);
+
+/**
+ * Set the key set used for decoded objects
+ *
+ * See `json5_parser_set_keyset`. The key set is kept when the coder is reset
+ * and has to be valid while the coder is used.
+ */
+extern void json5_coder_set_keyset (json5_coder * coder, json5_keyset const * keyset);
+
 /**
  * Decode a JSON string
  */
 extern int json5_coder_decode (json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_value);
+
+/**
+ * Decode a JSON string into an existing value
+ *
+ * Reuses the allocated containers, strings and object keys of @p value, so
+ * decoding documents of the same shape repeatedly does almost no
+ * allocations. Object properties are ordered as in the document, like with
+ * `json5_coder_decode`. Parser callback functions are ignored. On error,
+ * @p value contains a partially updated value.
+ */
+extern int json5_coder_decode_into (json5_coder * coder, uint8_t const * string, size_t size, json5_value * value);
+
+/**
+ * Decode a JSON string incrementally
+ *
+ * Consumes the characters from @p chars up to @p end until @p budget is
+ * exhausted and advances @p chars past the consumed characters. All state is
+ * kept in the coder, so the function can be called again with the remaining
+ * characters or the next chunk of input. If @p final is not 0, the characters
+ * up to @p end are the last ones. The time budget is checked after every few
+ * kilobytes, so it may be exceeded slightly. @p budget may be `NULL`.
+ *
+ * Has to be preceded by `json5_coder_reset` when decoding a new string.
+ * Parser callback functions are ignored.
+ *
+ * Returns `JSON5_CODER_CONTINUE` if the budget is exhausted, 0 if all
+ * characters are consumed, or -1 if an error occurred. If @p final is not 0
+ * and 0 is returned, the value can be taken with `json5_coder_take_value`.
+ */
+extern int json5_coder_decode_step (json5_coder * coder, uint8_t const ** chars, uint8_t const * end, int final, json5_coder_budget const * budget);
+
+/**
+ * Move the value decoded by `json5_coder_decode_step` to @p out_value
+ *
+ * Returns 0 on success or -1 if the value is not complete or an error
+ * occurred.
+ */
+extern int json5_coder_take_value (json5_coder * coder, json5_value * out_value);
+
+/**
+ * Decode a stream of multiple JSON documents
+ *
+ * Documents may be separated by linebreaks or any other whitespace. The
+ * characters can be pushed in chunks of any size. Each complete document is
+ * passed to @p func. Pass `NULL` and 0 to mark the end of the stream.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_coder_put_docs (json5_coder * coder, uint8_t const * chars, size_t size, json5_coder_value_func func, void * arg);
+
+/**
+ * Decode a JSON string and pass the items of arrays at nesting @p depth to
+ * @p func one by one
+ *
+ * A @p depth of 0 selects the root array. Only one item is held in memory at
+ * a time. The characters can be pushed in chunks of any size. Pass `NULL` and
+ * 0 to mark the end of the input. The remaining value with emptied arrays is
+ * then left in `coder -> parser.value`.
+ *
+ * Has to be preceded by `json5_coder_reset` when decoding a new string.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_coder_put_items (json5_coder * coder, uint8_t const * chars, size_t size, size_t depth, json5_coder_value_func func, void * arg);
+
+/**
+ * Returns the last error message or NULL if no error is present.
+ */
+extern char const * json5_coder_get_error (json5_coder const * coder);
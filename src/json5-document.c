@@ -0,0 +1,527 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "json5-document.h"
+
+#define INIT_SLOTS_CAP 64
+#define INIT_STRINGS_CAP 16
+
+/**
+ * Objects with more properties get a lookup table
+ */
+#define LINEAR_LOOKUP_MAX 8
+
+/**
+ * Set on object nodes which are in the lookup table
+ */
+#define JSON5_DOC_HASHED 4
+
+static json5_hash json5_doc_hash (size_t object, uint8_t const * key, size_t key_len) {
+	return json5_hash_key ((char const *) key, key_len) ^ (object * 0x9E3779B97F4A7C15ULL);
+}
+
+int json5_doc_init (json5_doc * doc) {
+	memset (doc, 0, sizeof (*doc));
+
+	return 0;
+}
+
+/**
+ * Release the strings and lookup tables of the previous string
+ */
+static void json5_doc_clear (json5_doc * doc) {
+	for (size_t i = 0; i < doc -> strings_len; i ++) {
+		free (doc -> strings [i].chars);
+	}
+
+	doc -> strings_len = 0;
+
+	if (doc -> slots_len) {
+		memset (doc -> slots, 0, doc -> slots_cap * sizeof (*doc -> slots));
+		doc -> slots_len = 0;
+	}
+
+	doc -> index.len = 0;
+}
+
+void json5_doc_destroy (json5_doc * doc) {
+	json5_doc_clear (doc);
+	json5_index_destroy (&doc -> index);
+	json5_value_set_null (&doc -> scratch);
+	free (doc -> strings);
+	free (doc -> slots);
+
+	memset (doc, 0, sizeof (*doc));
+}
+
+/**
+ * Check if the limits of the coder may be exceeded
+ *
+ * The index only gives upper bounds, so the string has to be decoded to check
+ * the limits exactly.
+ */
+static int json5_doc_may_exceed_limits (json5_doc const * doc) {
+	json5_index const * index = &doc -> index;
+	json5_limits const * limits = &doc -> coder -> parser.limits;
+	size_t max_length = doc -> coder -> tknzr.max_length;
+
+	if (limits -> max_depth && index -> depth > limits -> max_depth) {
+		return 1;
+	}
+
+	if (limits -> max_values && index -> values > limits -> max_values) {
+		return 1;
+	}
+
+	if (max_length && index -> max_string > max_length) {
+		return 1;
+	}
+
+	// decoded strings are never longer than their tokens
+	if (limits -> max_bytes && index -> len * (sizeof (json5_obj_prop) + 1) + doc -> size > limits -> max_bytes) {
+		return 1;
+	}
+
+	return 0;
+}
+
+int json5_doc_decode (json5_doc * doc, json5_coder * coder, uint8_t const * string, size_t size) {
+	int res;
+	int indexed;
+	json5_value value = JSON5_VALUE_INIT;
+
+	json5_doc_clear (doc);
+	json5_coder_reset (coder);
+
+	doc -> coder = coder;
+	doc -> chars = string;
+	doc -> size = size;
+	doc -> dup_policy = coder -> parser.dup_policy;
+
+	indexed = json5_validate_index (string, size, &doc -> index, NULL) == 0;
+
+	// repeated keys are only detected by the parser
+	if (indexed && doc -> dup_policy != JSON5_DUP_REJECT && !json5_doc_may_exceed_limits (doc)) {
+		return 0;
+	}
+
+	// decode to set the same error message as `json5_coder_decode`
+	res = json5_coder_decode (coder, string, size, &value);
+	json5_value_set_null (&value);
+
+	if (res != 0 || !indexed) {
+		doc -> index.len = 0;
+
+		return -1;
+	}
+
+	return 0;
+}
+
+json5_type json5_doc_get_type (json5_doc * doc, size_t node) {
+	uint8_t c;
+	json5_index_node const * n;
+	json5_value number = JSON5_VALUE_INIT;
+
+	if (node >= doc -> index.len) {
+		return JSON5_TYPE_NULL;
+	}
+
+	n = &doc -> index.nodes [node];
+
+	if (n -> flags & JSON5_NODE_KEY) {
+		return JSON5_TYPE_STRING;
+	}
+
+	switch (n -> type) {
+		case JSON5_NODE_OBJECT: {
+			return JSON5_TYPE_OBJECT;
+			break;
+		}
+		case JSON5_NODE_ARRAY: {
+			return JSON5_TYPE_ARRAY;
+			break;
+		}
+		case JSON5_NODE_KEYWORD: {
+			c = doc -> chars [n -> offset];
+
+			if (c == '+' || c == '-') {
+				c = doc -> chars [n -> offset + 1];
+			}
+
+			switch (c) {
+				case 't':
+				case 'f': {
+					return JSON5_TYPE_BOOL;
+					break;
+				}
+				case 'n': {
+					return JSON5_TYPE_NULL;
+					break;
+				}
+				case 'N': {
+					return JSON5_TYPE_NAN;
+					break;
+				}
+				default: {
+					return JSON5_TYPE_INFINITY;
+					break;
+				}
+			}
+			break;
+		}
+		case JSON5_NODE_NUMBER: {
+			// large integers are converted to floats
+			if (json5_coder_decode (doc -> coder, &doc -> chars [n -> offset], n -> length, &number) != 0) {
+				return JSON5_TYPE_NULL;
+			}
+
+			return number.type;
+			break;
+		}
+		default: {
+			return JSON5_TYPE_STRING;
+			break;
+		}
+	}
+}
+
+size_t json5_doc_get_len (json5_doc const * doc, size_t node) {
+	json5_index_node const * n;
+
+	if (node >= doc -> index.len) {
+		return 0;
+	}
+
+	n = &doc -> index.nodes [node];
+
+	if (n -> type != JSON5_NODE_OBJECT && n -> type != JSON5_NODE_ARRAY) {
+		return 0;
+	}
+
+	return n -> count;
+}
+
+size_t json5_doc_get_item (json5_doc const * doc, size_t node, size_t idx) {
+	json5_index_node const * nodes = doc -> index.nodes;
+	size_t item;
+
+	if (node >= doc -> index.len || nodes [node].type != JSON5_NODE_ARRAY || idx >= nodes [node].count) {
+		return JSON5_DOC_NONE;
+	}
+
+	for (item = node + 1; idx; idx --) {
+		item = nodes [item].next;
+	}
+
+	return item;
+}
+
+uint8_t const * json5_doc_get_string (json5_doc * doc, size_t node, size_t * out_len) {
+	json5_index_node * n;
+	json5_doc_string * str;
+	size_t new_cap;
+
+	if (node >= doc -> index.len) {
+		return NULL;
+	}
+
+	n = &doc -> index.nodes [node];
+
+	switch (n -> type) {
+		case JSON5_NODE_STRING: {
+			if (!(n -> flags & JSON5_NODE_ESCAPED)) {
+				*out_len = n -> length - 2;
+
+				return &doc -> chars [n -> offset + 1];
+			}
+
+			// `count` holds the index of the unescaped string + 1
+			if (!n -> count) {
+				if (doc -> strings_len >= doc -> strings_cap) {
+					new_cap = doc -> strings_cap ? doc -> strings_cap * 2 : INIT_STRINGS_CAP;
+					str = realloc (doc -> strings, new_cap * sizeof (*str));
+
+					if (!str) {
+						return NULL;
+					}
+
+					doc -> strings = str;
+					doc -> strings_cap = new_cap;
+				}
+
+				if (json5_coder_decode (doc -> coder, &doc -> chars [n -> offset], n -> length, &doc -> scratch) != 0) {
+					return NULL;
+				}
+
+				// copy, as short strings are stored inside the value
+				str = &doc -> strings [doc -> strings_len];
+				str -> len = doc -> scratch.len;
+
+				if (!(str -> chars = malloc (str -> len + 1))) {
+					return NULL;
+				}
+
+				memcpy (str -> chars, json5_value_get_string (&doc -> scratch), str -> len + 1);
+				n -> count = ++ doc -> strings_len;
+			}
+
+			str = &doc -> strings [n -> count - 1];
+			*out_len = str -> len;
+
+			return str -> chars;
+			break;
+		}
+		case JSON5_NODE_KEYWORD:
+		case JSON5_NODE_NAME: {
+			if (!(n -> flags & JSON5_NODE_KEY)) {
+				return NULL;
+			}
+
+			*out_len = n -> length;
+
+			return &doc -> chars [n -> offset];
+			break;
+		}
+		default: {
+			return NULL;
+			break;
+		}
+	}
+}
+
+static int json5_doc_resize_slots (json5_doc * doc, size_t new_cap) {
+	json5_doc_slot * new_slots;
+	json5_doc_slot * slot;
+	size_t mask = new_cap - 1;
+	size_t i;
+
+	new_slots = calloc (new_cap, sizeof (*new_slots));
+
+	if (!new_slots) {
+		return -1;
+	}
+
+	for (size_t s = 0; s < doc -> slots_cap; s ++) {
+		slot = &doc -> slots [s];
+
+		if (slot -> object) {
+			for (i = slot -> hash & mask; new_slots [i].object; i = (i + 1) & mask);
+			new_slots [i] = *slot;
+		}
+	}
+
+	free (doc -> slots);
+	doc -> slots = new_slots;
+	doc -> slots_cap = new_cap;
+
+	return 0;
+}
+
+/**
+ * Find the slot of a key or the empty slot where it would be inserted
+ */
+static json5_doc_slot * json5_doc_find_slot (json5_doc * doc, size_t node, json5_hash hash, uint8_t const * key, size_t key_len) {
+	json5_doc_slot * slot;
+	uint8_t const * slot_key;
+	size_t slot_len;
+	size_t mask = doc -> slots_cap - 1;
+
+	for (size_t i = hash & mask;; i = (i + 1) & mask) {
+		slot = &doc -> slots [i];
+
+		if (!slot -> object) {
+			return slot;
+		}
+
+		if (slot -> object == node + 1 && slot -> hash == hash) {
+			slot_key = json5_doc_get_string (doc, slot -> key, &slot_len);
+
+			if (slot_key && slot_len == key_len && memcmp (slot_key, key, key_len) == 0) {
+				return slot;
+			}
+		}
+	}
+}
+
+/**
+ * Add all properties of an object to the lookup table
+ */
+static int json5_doc_hash_object (json5_doc * doc, size_t node) {
+	json5_index_node * nodes = doc -> index.nodes;
+	json5_doc_slot * slot;
+	uint8_t const * key;
+	size_t key_len;
+	size_t new_cap;
+	json5_hash hash;
+
+	// keep load factor below 0.5
+	if ((doc -> slots_len + nodes [node].count) * 2 > doc -> slots_cap) {
+		new_cap = doc -> slots_cap ? doc -> slots_cap : INIT_SLOTS_CAP;
+
+		while ((doc -> slots_len + nodes [node].count) * 2 > new_cap) {
+			new_cap *= 2;
+		}
+
+		if (json5_doc_resize_slots (doc, new_cap) != 0) {
+			return -1;
+		}
+	}
+
+	for (size_t k = node + 1; k < nodes [node].next; k = nodes [k + 1].next) {
+		if (!(key = json5_doc_get_string (doc, k, &key_len))) {
+			return -1;
+		}
+
+		hash = json5_doc_hash (node, key, key_len);
+		slot = json5_doc_find_slot (doc, node, hash, key, key_len);
+
+		if (!slot -> object) {
+			slot -> hash = hash;
+			slot -> object = node + 1;
+			slot -> key = k;
+			doc -> slots_len ++;
+		}
+		else if (doc -> dup_policy != JSON5_DUP_FIRST) {
+			slot -> key = k;
+		}
+	}
+
+	nodes [node].flags |= JSON5_DOC_HASHED;
+
+	return 0;
+}
+
+size_t json5_doc_get_prop (json5_doc * doc, size_t node, char const * key, size_t key_len) {
+	json5_index_node const * nodes = doc -> index.nodes;
+	json5_doc_slot * slot;
+	uint8_t const * prop_key;
+	size_t prop_len;
+	size_t found = JSON5_DOC_NONE;
+
+	if (node >= doc -> index.len || nodes [node].type != JSON5_NODE_OBJECT) {
+		return JSON5_DOC_NONE;
+	}
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	if (nodes [node].count <= LINEAR_LOOKUP_MAX) {
+		for (size_t k = node + 1; k < nodes [node].next; k = nodes [k + 1].next) {
+			if (!(prop_key = json5_doc_get_string (doc, k, &prop_len))) {
+				return JSON5_DOC_NONE;
+			}
+
+			if (prop_len == key_len && memcmp (prop_key, key, key_len) == 0) {
+				found = k + 1;
+
+				if (doc -> dup_policy == JSON5_DUP_FIRST) {
+					break;
+				}
+			}
+		}
+
+		return found;
+	}
+
+	if (!(nodes [node].flags & JSON5_DOC_HASHED)) {
+		if (json5_doc_hash_object (doc, node) != 0) {
+			return JSON5_DOC_NONE;
+		}
+	}
+
+	slot = json5_doc_find_slot (doc, node, json5_doc_hash (node, (uint8_t const *) key, key_len), (uint8_t const *) key, key_len);
+
+	if (!slot -> object) {
+		return JSON5_DOC_NONE;
+	}
+
+	return slot -> key + 1;
+}
+
+int json5_doc_get_value (json5_doc * doc, size_t node, json5_value * value) {
+	json5_index_node const * n;
+	uint8_t const * chars;
+	size_t len;
+
+	if (node >= doc -> index.len) {
+		return -1;
+	}
+
+	n = &doc -> index.nodes [node];
+
+	if (n -> type == JSON5_NODE_STRING || (n -> flags & JSON5_NODE_KEY)) {
+		if (!(chars = json5_doc_get_string (doc, node, &len))) {
+			return -1;
+		}
+
+		return json5_value_set_string (value, (char const *) chars, len);
+	}
+
+	return json5_coder_decode (doc -> coder, &doc -> chars [n -> offset], n -> length, value);
+}
+
+int json5_doc_itor_init (json5_doc_itor * itor, json5_doc * doc, size_t node) {
+	json5_index_node const * n;
+
+	if (node >= doc -> index.len) {
+		return -1;
+	}
+
+	n = &doc -> index.nodes [node];
+
+	if (n -> type != JSON5_NODE_OBJECT && n -> type != JSON5_NODE_ARRAY) {
+		return -1;
+	}
+
+	itor -> doc = doc;
+	itor -> node = node + 1;
+	itor -> end = n -> next;
+	itor -> object = n -> type == JSON5_NODE_OBJECT;
+
+	return 0;
+}
+
+int json5_doc_itor_next (json5_doc_itor * itor, size_t * out_key, size_t * out_value) {
+	json5_index_node const * nodes = itor -> doc -> index.nodes;
+
+	if (itor -> node >= itor -> end) {
+		return 0;
+	}
+
+	if (itor -> object) {
+		*out_key = itor -> node;
+		*out_value = itor -> node + 1;
+	}
+	else {
+		*out_key = JSON5_DOC_NONE;
+		*out_value = itor -> node;
+	}
+
+	itor -> node = nodes [*out_value].next;
+
+	return 1;
+}
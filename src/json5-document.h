@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+#include "json5-validator.h"
+
+/**
+ * Returned by lookup functions if no node is found.
+ */
+#define JSON5_DOC_NONE ((size_t) -1)
+
+/**
+ * Defines an unescaped string.
+ */
+typedef struct {
+	uint8_t * chars; ///< The characters.
+	size_t len;      ///< The length in bytes.
+} json5_doc_string;
+
+/**
+ * Defines a lookup table slot of an object member.
+ */
+typedef struct {
+	json5_hash hash; ///< The key hash.
+	size_t object;   ///< The object node index + 1. 0 if the slot is empty.
+	size_t key;      ///< The key node index.
+} json5_doc_slot;
+
+/**
+ * The lazy document object.
+ *
+ * Holds a structural index of a JSON string. Nodes are referenced by their
+ * index; the root value is node 0. Strings are unescaped, numbers converted
+ * and object lookup tables built only when a node is accessed.
+ */
+typedef struct {
+	json5_coder * coder;         ///< The coder used to decode accessed values.
+	uint8_t const * chars;       ///< The indexed string. It is not copied.
+	size_t size;                 ///< The string size in bytes.
+	json5_index index;           ///< The structural index.
+	json5_dup_policy dup_policy; ///< How repeated keys are resolved.
+	json5_doc_string * strings;  ///< Unescaped strings of escaped nodes.
+	size_t strings_len;          ///< Number of unescaped strings.
+	size_t strings_cap;          ///< Unescaped string capacity.
+	json5_value scratch;         ///< Decoding buffer.
+	json5_doc_slot * slots;      ///< Lookup table of accessed objects.
+	size_t slots_len;            ///< Number of used slots.
+	size_t slots_cap;            ///< Lookup table capacity.
+} json5_doc;
+
+/**
+ * Defines a container iterator.
+ */
+typedef struct {
+	json5_doc * doc; ///< The document.
+	size_t node;     ///< The next child node.
+	size_t end;      ///< The node following the container.
+	int object;      ///< If the container is an object.
+} json5_doc_itor;
+
+/**
+ * Initialize a document.
+ *
+ * @return 0 on success.
+ */
+extern int json5_doc_init (json5_doc * doc);
+
+/**
+ * Destroy a document.
+ */
+extern void json5_doc_destroy (json5_doc * doc);
+
+/**
+ * Index a JSON string with a single fast scan.
+ *
+ * The string has to stay valid and unchanged as long as the document is
+ * used. @p coder is used to decode values on access and has to outlive the
+ * document. It can still be used for other decoding in between. The limits
+ * set on @p coder apply to the whole string. Repeated keys resolve to the
+ * first value with `JSON5_DUP_FIRST` and to the last value with
+ * `JSON5_DUP_LAST`. With `JSON5_DUP_REJECT` the string is decoded once to
+ * check for repeated keys.
+ *
+ * @param doc The document. Previously indexed strings are released.
+ * @param coder The coder.
+ * @param string The string to index.
+ * @param size The string size in bytes.
+ *
+ * @return 0 on success otherwise -1. The error message can be read with
+ * `json5_coder_get_error`.
+ */
+extern int json5_doc_decode (json5_doc * doc, json5_coder * coder, uint8_t const * string, size_t size);
+
+/**
+ * Get the value type of a node.
+ *
+ * Unquoted keys are strings. Numbers are converted to tell integers from
+ * floats.
+ */
+extern json5_type json5_doc_get_type (json5_doc * doc, size_t node);
+
+/**
+ * Get the number of items or properties of a container node.
+ *
+ * @return The number of children or 0 if the node is not a container.
+ */
+extern size_t json5_doc_get_len (json5_doc const * doc, size_t node);
+
+/**
+ * Get an array item.
+ *
+ * Items are found by skipping their predecessors. Use an iterator to visit
+ * all items.
+ *
+ * @return The item node or `JSON5_DOC_NONE`.
+ */
+extern size_t json5_doc_get_item (json5_doc const * doc, size_t node, size_t idx);
+
+/**
+ * Get an object property.
+ *
+ * A lookup table is built on the first lookup in a larger object.
+ *
+ * @param doc The document.
+ * @param node The object node.
+ * @param key The key.
+ * @param key_len The key length in bytes. If -1, `strlen` is used.
+ *
+ * @return The value node or `JSON5_DOC_NONE` if the key does not exist, the
+ * node is not an object or an allocation error occurred.
+ */
+extern size_t json5_doc_get_prop (json5_doc * doc, size_t node, char const * key, size_t key_len);
+
+/**
+ * Get the unescaped characters of a string or key node.
+ *
+ * The characters are not null-terminated. They are valid as long as the
+ * document is not destroyed or used for a new string.
+ *
+ * @param doc The document.
+ * @param node A string node or key node.
+ * @param out_len Set to the length in bytes.
+ *
+ * @return The characters or `NULL` if the node is not a string or an error
+ * occurred.
+ */
+extern uint8_t const * json5_doc_get_string (json5_doc * doc, size_t node, size_t * out_len);
+
+/**
+ * Decode a node into a value.
+ *
+ * Containers are decoded with all their children.
+ *
+ * @return 0 on success otherwise -1.
+ */
+extern int json5_doc_get_value (json5_doc * doc, size_t node, json5_value * value);
+
+/**
+ * Initialize a container iterator.
+ *
+ * @return 0 on success otherwise a value != 0 if @p node is not a container.
+ */
+extern int json5_doc_itor_init (json5_doc_itor * itor, json5_doc * doc, size_t node);
+
+/**
+ * Get the next child.
+ *
+ * @param itor The iterator.
+ * @param out_key Set to the key node. `JSON5_DOC_NONE` for array items.
+ * @param out_value Set to the value node.
+ *
+ * @return 1 as long as more children exist.
+ */
+extern int json5_doc_itor_next (json5_doc_itor * itor, size_t * out_key, size_t * out_value);
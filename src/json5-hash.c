@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+#include "json5-hash.h"
+
+#define HASH_P0 0xA0761D6478BD642FULL
+#define HASH_P1 0xE7037ED1A0B428DBULL
+#define HASH_P2 0x8EBC6AF09C88C6E3ULL
+
+#define ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+static inline uint64_t json5_read64 (uint8_t const * p) {
+	uint64_t v;
+
+	memcpy (&v, p, sizeof (v));
+
+	return v;
+}
+
+static inline uint64_t json5_read32 (uint8_t const * p) {
+	uint32_t v;
+
+	memcpy (&v, p, sizeof (v));
+
+	return v;
+}
+
+/**
+ * Multiply @p a and @p b and store the low and high 64 bits in @p a and @p b
+ */
+static inline void json5_mum (uint64_t * a, uint64_t * b) {
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t) *a * *b;
+
+	*a = (uint64_t) r;
+	*b = (uint64_t) (r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t) *a, lb = (uint32_t) *b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+json5_hash json5_hash_mix (json5_hash a, json5_hash b) {
+	json5_mum (&a, &b);
+
+	return a ^ b;
+}
+
+json5_hash json5_hash_fast (void const * data, size_t size, json5_hash seed) {
+	uint8_t const * p = data;
+	uint64_t a, b;
+	size_t i = size;
+
+	seed ^= json5_hash_mix (seed ^ HASH_P0, HASH_P1);
+
+	if (size <= 16) {
+		if (size >= 4) {
+			a = (json5_read32 (p) << 32) | json5_read32 (&p [(size >> 3) << 2]);
+			b = (json5_read32 (&p [size - 4]) << 32) | json5_read32 (&p [size - 4 - ((size >> 3) << 2)]);
+		}
+		else if (size > 0) {
+			a = ((uint64_t) p [0] << 16) | ((uint64_t) p [size >> 1] << 8) | p [size - 1];
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		while (i > 16) {
+			seed = json5_hash_mix (json5_read64 (p) ^ HASH_P1, json5_read64 (&p [8]) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+
+		a = json5_read64 (&p [i - 16]);
+		b = json5_read64 (&p [i - 8]);
+	}
+
+	a ^= HASH_P1;
+	b ^= seed;
+	json5_mum (&a, &b);
+
+	return json5_hash_mix (a ^ HASH_P0 ^ size, b ^ HASH_P1);
+}
+
+#define SIP_ROUND(v0, v1, v2, v3) do { \
+	v0 += v1; v1 = ROTL (v1, 13); v1 ^= v0; v0 = ROTL (v0, 32); \
+	v2 += v3; v3 = ROTL (v3, 16); v3 ^= v2; \
+	v0 += v3; v3 = ROTL (v3, 21); v3 ^= v0; \
+	v2 += v1; v1 = ROTL (v1, 17); v1 ^= v2; v2 = ROTL (v2, 32); \
+} while (0)
+
+json5_hash json5_hash_sip (void const * data, size_t size, json5_hash seed) {
+	uint8_t const * p = data;
+	uint64_t k0 = seed;
+	uint64_t k1 = json5_hash_mix (seed ^ HASH_P2, HASH_P0);
+	uint64_t v0 = k0 ^ 0x736F6D6570736575ULL;
+	uint64_t v1 = k1 ^ 0x646F72616E646F6DULL;
+	uint64_t v2 = k0 ^ 0x6C7967656E657261ULL;
+	uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+	uint64_t m;
+	uint64_t last = (uint64_t) size << 56;
+	size_t i;
+
+	for (i = 0; i + 8 <= size; i += 8) {
+		m = json5_read64 (&p [i]);
+		v3 ^= m;
+		SIP_ROUND (v0, v1, v2, v3);
+		v0 ^= m;
+	}
+
+	for (size_t j = 0; i < size; i ++, j ++) {
+		last |= (uint64_t) p [i] << (j * 8);
+	}
+
+	v3 ^= last;
+	SIP_ROUND (v0, v1, v2, v3);
+	v0 ^= last;
+
+	v2 ^= 0xFF;
+	SIP_ROUND (v0, v1, v2, v3);
+	SIP_ROUND (v0, v1, v2, v3);
+	SIP_ROUND (v0, v1, v2, v3);
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
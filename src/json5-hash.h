@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-value.h"
+
+/**
+ * Hash @p size bytes with a fast keyed hash processing 16 bytes per step.
+ * Uses the multiply-mix construction of wyhash.
+ *
+ * @param data The bytes to hash.
+ * @param size The number of bytes.
+ * @param seed The hash seed.
+ *
+ * @return The hash value.
+ */
+extern json5_hash json5_hash_fast (void const * data, size_t size, json5_hash seed);
+
+/**
+ * Hash @p size bytes with SipHash-1-3. Slower than `json5_hash_fast`, but
+ * collisions cannot be computed without knowing @p seed.
+ *
+ * @param data The bytes to hash.
+ * @param size The number of bytes.
+ * @param seed The hash seed. Expanded to the 128-bit SipHash key.
+ *
+ * @return The hash value.
+ */
+extern json5_hash json5_hash_sip (void const * data, size_t size, json5_hash seed);
+
+/**
+ * Mix two 64-bit values by folding their 128-bit product.
+ *
+ * @param a The first value.
+ * @param b The second value.
+ *
+ * @return The mixed value.
+ */
+extern json5_hash json5_hash_mix (json5_hash a, json5_hash b);
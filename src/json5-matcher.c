@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "json5-matcher.h"
+
+#define INIT_STACK_CAP 16
+
+static int json5_matcher_begin_arr (json5_token const * token, void * arg);
+static int json5_matcher_begin_obj (json5_token const * token, void * arg);
+static int json5_matcher_end_container (json5_token const * token, void * arg);
+static int json5_matcher_begin_key (json5_token const * token, void * arg);
+static int json5_matcher_begin_index (json5_token const * token, void * arg);
+static int json5_matcher_set_value (json5_token const * token, void * arg);
+
+static json5_parser_funcs const json5_matcher_funcs = {
+	.begin_arr     = json5_matcher_begin_arr,
+	.begin_obj     = json5_matcher_begin_obj,
+	.end_container = json5_matcher_end_container,
+	.begin_key     = json5_matcher_begin_key,
+	.begin_index   = json5_matcher_begin_index,
+	.set_value     = json5_matcher_set_value,
+};
+
+int json5_matcher_init (json5_matcher * matcher) {
+	memset (matcher, 0, sizeof (*matcher));
+
+	return 0;
+}
+
+void json5_matcher_destroy (json5_matcher * matcher) {
+	for (size_t i = 0; i < matcher -> paths_len; i ++) {
+		free (matcher -> paths [i].name);
+		free (matcher -> paths [i].segs);
+	}
+
+	free (matcher -> paths);
+	free (matcher -> stack);
+	json5_value_set_null (&matcher -> capture);
+
+	memset (matcher, 0, sizeof (*matcher));
+}
+
+/**
+ * Parse path `name` into segments.
+ */
+static int json5_matcher_compile (json5_matcher_path * path) {
+	size_t i = 0;
+	size_t start;
+	size_t count = 1;
+	uint8_t const * str = path -> name;
+	size_t len = path -> name_len;
+	json5_matcher_seg * seg;
+
+	for (i = 0; i < len; i ++) {
+		if (str [i] == '.' || str [i] == '[') {
+			count ++;
+		}
+	}
+
+	path -> segs = calloc (count, sizeof (*path -> segs));
+
+	if (!path -> segs) {
+		return -1;
+	}
+
+	i = 0;
+
+	while (i < len) {
+		seg = &path -> segs [path -> len];
+
+		if (str [i] == '[') {
+			i ++;
+
+			if (i < len && (str [i] == '"' || str [i] == '\'')) {
+				int quote = str [i ++];
+
+				start = i;
+
+				while (i < len && str [i] != quote) {
+					i ++;
+				}
+
+				if (i >= len) {
+					return -1;
+				}
+
+				seg -> type = JSON5_SEG_KEY;
+				seg -> key = &path -> name [start];
+				seg -> key_len = i - start;
+				i ++;
+			}
+			else if (i < len && str [i] == '*') {
+				seg -> type = JSON5_SEG_ANY;
+				path -> multi = 1;
+				i ++;
+			}
+			else {
+				start = i;
+				seg -> type = JSON5_SEG_INDEX;
+
+				while (i < len && str [i] >= '0' && str [i] <= '9') {
+					seg -> index = seg -> index * 10 + (str [i] - '0');
+					i ++;
+				}
+
+				if (i == start) {
+					return -1;
+				}
+			}
+
+			if (i >= len || str [i] != ']') {
+				return -1;
+			}
+
+			i ++;
+		}
+		else {
+			if (path -> len) {
+				if (str [i] != '.') {
+					return -1;
+				}
+
+				i ++;
+			}
+
+			start = i;
+
+			while (i < len && str [i] != '.' && str [i] != '[') {
+				i ++;
+			}
+
+			if (i == start) {
+				return -1;
+			}
+
+			if (i - start == 1 && str [start] == '*') {
+				seg -> type = JSON5_SEG_ANY;
+				path -> multi = 1;
+			}
+			else {
+				seg -> type = JSON5_SEG_KEY;
+				seg -> key = &path -> name [start];
+				seg -> key_len = i - start;
+			}
+		}
+
+		path -> len ++;
+	}
+
+	if (!path -> len) {
+		return -1;
+	}
+
+	return 0;
+}
+
+ssize_t json5_matcher_add_path (json5_matcher * matcher, char const * path, size_t path_len) {
+	json5_matcher_path * paths;
+	json5_matcher_path * new_path;
+
+	if (matcher -> paths_len >= JSON5_MATCHER_MAX_PATHS) {
+		return -1;
+	}
+
+	if (path_len == (size_t) -1) {
+		path_len = strlen (path);
+	}
+
+	paths = realloc (matcher -> paths, (matcher -> paths_len + 1) * sizeof (*paths));
+
+	if (!paths) {
+		return -1;
+	}
+
+	matcher -> paths = paths;
+	new_path = &paths [matcher -> paths_len];
+	memset (new_path, 0, sizeof (*new_path));
+
+	new_path -> name = malloc (path_len + 1);
+
+	if (!new_path -> name) {
+		return -1;
+	}
+
+	memcpy (new_path -> name, path, path_len);
+	new_path -> name [path_len] = '\0';
+	new_path -> name_len = path_len;
+
+	if (json5_matcher_compile (new_path) != 0) {
+		free (new_path -> name);
+		free (new_path -> segs);
+
+		return -1;
+	}
+
+	return matcher -> paths_len ++;
+}
+
+void json5_matcher_set_func (json5_matcher * matcher, json5_matcher_func func, void * arg) {
+	matcher -> func = func;
+	matcher -> func_arg = arg;
+}
+
+static json5_matcher_frame * json5_matcher_push (json5_matcher * matcher, uint64_t mask, json5_value * value) {
+	json5_matcher_frame * frame;
+
+	if (matcher -> stack_len >= matcher -> stack_cap) {
+		size_t new_cap = matcher -> stack_cap ? matcher -> stack_cap * 2 : INIT_STACK_CAP;
+
+		frame = realloc (matcher -> stack, new_cap * sizeof (*frame));
+
+		if (!frame) {
+			return NULL;
+		}
+
+		matcher -> stack = frame;
+		matcher -> stack_cap = new_cap;
+	}
+
+	frame = &matcher -> stack [matcher -> stack_len ++];
+	frame -> mask = mask;
+	frame -> index = 0;
+	frame -> value = value;
+
+	return frame;
+}
+
+/**
+ * Get paths from `mask` ending at current depth.
+ */
+static uint64_t json5_matcher_terminal_mask (json5_matcher const * matcher, uint64_t mask) {
+	uint64_t terminal = 0;
+
+	for (size_t i = 0; mask && i < matcher -> paths_len; i ++) {
+		uint64_t bit = 1ULL << i;
+
+		if ((mask & bit) && matcher -> paths [i].len == matcher -> stack_len) {
+			terminal |= bit;
+		}
+	}
+
+	return terminal;
+}
+
+/**
+ * Get the target value for a match of `path`.
+ */
+static json5_value * json5_matcher_target (json5_matcher * matcher, size_t path_idx) {
+	json5_value * value;
+	json5_matcher_path const * path = &matcher -> paths [path_idx];
+
+	if (matcher -> func) {
+		return &matcher -> capture;
+	}
+
+	if (path -> multi) {
+		value = json5_value_get_prop (matcher -> result, (char const *) path -> name, path -> name_len);
+
+		return json5_value_append_item (value);
+	}
+
+	return json5_value_set_prop (matcher -> result, (char const *) path -> name, path -> name_len, 1);
+}
+
+static int json5_matcher_deliver (json5_matcher * matcher, size_t path_idx) {
+	int res = 0;
+
+	if (matcher -> func) {
+		res = matcher -> func (path_idx, &matcher -> capture, matcher -> func_arg);
+		json5_value_set_null (&matcher -> capture);
+	}
+
+	return res;
+}
+
+/**
+ * Find target for the next value. Returns 1 if the value should be built,
+ * 0 if it is skipped and -1 if an allocation error occured.
+ */
+static int json5_matcher_begin_value (json5_matcher * matcher, json5_value ** out_target, size_t * out_path) {
+	uint64_t terminal;
+	size_t path_idx = 0;
+
+	if (matcher -> capture_depth) {
+		*out_target = matcher -> next_value;
+
+		return 1;
+	}
+
+	terminal = json5_matcher_terminal_mask (matcher, matcher -> next_mask);
+
+	if (!terminal) {
+		return 0;
+	}
+
+	while (!(terminal & (1ULL << path_idx))) {
+		path_idx ++;
+	}
+
+	*out_path = path_idx;
+	*out_target = json5_matcher_target (matcher, path_idx);
+
+	if (!*out_target) {
+		return -1;
+	}
+
+	return 1;
+}
+
+static int json5_matcher_begin_container (json5_matcher * matcher, json5_type type) {
+	int res;
+	size_t path_idx = 0;
+	json5_value * target = NULL;
+
+	if ((res = json5_matcher_begin_value (matcher, &target, &path_idx)) < 0) {
+		return -1;
+	}
+
+	if (res) {
+		json5_value_reset (target, type);
+
+		if (!json5_matcher_push (matcher, 0, target)) {
+			return -1;
+		}
+
+		if (!matcher -> capture_depth) {
+			matcher -> capture_depth = matcher -> stack_len;
+			matcher -> capture_path = path_idx;
+		}
+	}
+	else {
+		if (!json5_matcher_push (matcher, matcher -> next_mask, NULL)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int json5_matcher_begin_arr (json5_token const * token, void * arg) {
+	return json5_matcher_begin_container (arg, JSON5_TYPE_ARRAY);
+}
+
+static int json5_matcher_begin_obj (json5_token const * token, void * arg) {
+	return json5_matcher_begin_container (arg, JSON5_TYPE_OBJECT);
+}
+
+static int json5_matcher_end_container (json5_token const * token, void * arg) {
+	json5_matcher * matcher = arg;
+	int res = 0;
+
+	if (matcher -> capture_depth == matcher -> stack_len) {
+		matcher -> capture_depth = 0;
+		res = json5_matcher_deliver (matcher, matcher -> capture_path);
+	}
+
+	matcher -> stack_len --;
+
+	return res;
+}
+
+static int json5_matcher_begin_key (json5_token const * token, void * arg) {
+	json5_matcher * matcher = arg;
+	json5_matcher_frame * frame = &matcher -> stack [matcher -> stack_len - 1];
+	json5_matcher_seg const * seg;
+	uint64_t mask = frame -> mask;
+	uint64_t next_mask = 0;
+
+	if (frame -> value) {
+		matcher -> next_value = json5_value_set_prop (frame -> value, (char const *) token -> token, token -> length, 1);
+
+		return matcher -> next_value ? 0 : -1;
+	}
+
+	for (size_t i = 0; mask && i < matcher -> paths_len; i ++) {
+		uint64_t bit = 1ULL << i;
+
+		if (mask & bit) {
+			seg = &matcher -> paths [i].segs [matcher -> stack_len - 1];
+
+			if (seg -> type == JSON5_SEG_ANY || (seg -> type == JSON5_SEG_KEY &&
+				seg -> key_len == token -> length && memcmp (seg -> key, token -> token, seg -> key_len) == 0)) {
+				next_mask |= bit;
+			}
+		}
+	}
+
+	matcher -> next_mask = next_mask;
+
+	return 0;
+}
+
+static int json5_matcher_begin_index (json5_token const * token, void * arg) {
+	json5_matcher * matcher = arg;
+	json5_matcher_frame * frame = &matcher -> stack [matcher -> stack_len - 1];
+	json5_matcher_seg const * seg;
+	uint64_t mask = frame -> mask;
+	uint64_t next_mask = 0;
+	size_t index = frame -> index ++;
+
+	if (frame -> value) {
+		matcher -> next_value = json5_value_append_item (frame -> value);
+
+		return matcher -> next_value ? 0 : -1;
+	}
+
+	for (size_t i = 0; mask && i < matcher -> paths_len; i ++) {
+		uint64_t bit = 1ULL << i;
+
+		if (mask & bit) {
+			seg = &matcher -> paths [i].segs [matcher -> stack_len - 1];
+
+			if (seg -> type == JSON5_SEG_ANY || (seg -> type == JSON5_SEG_INDEX && seg -> index == index)) {
+				next_mask |= bit;
+			}
+		}
+	}
+
+	matcher -> next_mask = next_mask;
+
+	return 0;
+}
+
+static int json5_matcher_set_value (json5_token const * token, void * arg) {
+	json5_matcher * matcher = arg;
+	json5_value * value = NULL;
+	size_t path_idx = 0;
+	int res;
+
+	if ((res = json5_matcher_begin_value (matcher, &value, &path_idx)) <= 0) {
+		return res;
+	}
+
+	switch (token -> type) {
+		case JSON5_TOK_STRING: {
+			if (json5_value_set_string (value, (char *) token -> token, token -> length) != 0) {
+				return -1;
+			}
+			break;
+		}
+		case JSON5_TOK_NUMBER: {
+			json5_value_set_int (value, token -> value.i);
+			break;
+		}
+		case JSON5_TOK_NUMBER_FLOAT: {
+			json5_value_set_float (value, token -> value.f);
+			break;
+		}
+		case JSON5_TOK_NUMBER_BOOL: {
+			json5_value_set_bool (value, token -> value.i != 0);
+			break;
+		}
+		case JSON5_TOK_NAN: {
+			json5_value_set_nan (value);
+			break;
+		}
+		case JSON5_TOK_INFINITY: {
+			json5_value_set_infinity (value, (int) token -> value.i);
+			break;
+		}
+		default: {
+			json5_value_set_null (value);
+			break;
+		}
+	}
+
+	if (!matcher -> capture_depth) {
+		return json5_matcher_deliver (matcher, path_idx);
+	}
+
+	return 0;
+}
+
+int json5_matcher_match (json5_matcher * matcher, json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_result) {
+	int res;
+	json5_value value = JSON5_VALUE_INIT;
+	json5_parser_funcs const * funcs = coder -> parser.funcs;
+	void * funcs_arg = coder -> parser.funcs_arg;
+
+	matcher -> stack_len = 0;
+	matcher -> next_mask = matcher -> paths_len < 64 ? (1ULL << matcher -> paths_len) - 1 : ~0ULL;
+	matcher -> next_value = NULL;
+	matcher -> capture_depth = 0;
+	matcher -> result = out_result;
+
+	if (!matcher -> func) {
+		if (!out_result) {
+			return -1;
+		}
+
+		json5_value_set_null (out_result);
+		json5_value_set_object (out_result);
+
+		for (size_t i = 0; i < matcher -> paths_len; i ++) {
+			json5_matcher_path const * path = &matcher -> paths [i];
+
+			if (path -> multi) {
+				json5_value * array = json5_value_set_prop (out_result, (char const *) path -> name, path -> name_len, 1);
+
+				if (!array) {
+					return -1;
+				}
+
+				json5_value_set_array (array);
+			}
+		}
+	}
+
+	coder -> parser.funcs = &json5_matcher_funcs;
+	coder -> parser.funcs_arg = matcher;
+
+	res = json5_coder_decode (coder, string, size, &value);
+
+	coder -> parser.funcs = funcs;
+	coder -> parser.funcs_arg = funcs_arg;
+
+	json5_value_set_null (&matcher -> capture);
+	json5_value_set_null (&value);
+
+	return res;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+
+/**
+ * Maximum number of paths a matcher can hold.
+ */
+#define JSON5_MATCHER_MAX_PATHS 64
+
+typedef struct json5_matcher json5_matcher;
+
+/**
+ * Defines path segment types.
+ */
+typedef enum {
+	JSON5_SEG_KEY,   ///< .key or ["key"]
+	JSON5_SEG_INDEX, ///< [42]
+	JSON5_SEG_ANY,   ///< .* or [*]
+} json5_seg_type;
+
+/**
+ * Defines a single path segment.
+ */
+typedef struct {
+	json5_seg_type type; ///< Segment type.
+	uint8_t * key;       ///< Object key if type is `JSON5_SEG_KEY`.
+	size_t key_len;      ///< Object key length in bytes.
+	size_t index;        ///< Array index if type is `JSON5_SEG_INDEX`.
+} json5_matcher_seg;
+
+/**
+ * Defines a compiled path.
+ */
+typedef struct {
+	uint8_t * name;           ///< The path as given to `json5_matcher_add_path`.
+	size_t name_len;          ///< The path length in bytes.
+	json5_matcher_seg * segs; ///< The path segments.
+	size_t len;               ///< Number of path segments.
+	int multi;                ///< If the path contains wildcards.
+} json5_matcher_path;
+
+/**
+ * Defines a matcher stack frame for an open container.
+ */
+typedef struct {
+	uint64_t mask;       ///< Paths matching up to this container.
+	size_t index;        ///< Next array index.
+	json5_value * value; ///< Container value if captured.
+} json5_matcher_frame;
+
+/**
+ * A callback function called for every matched value.
+ *
+ * @param path The index of the matching path as returned by
+ * `json5_matcher_add_path`.
+ * @param value The matched value. It is cleared after the function returns
+ * and can be moved with `json5_value_transfer`.
+ * @param arg The user argument.
+ *
+ * @return 0 to continue otherwise a value != 0 to abort.
+ */
+typedef int (*json5_matcher_func) (size_t path, json5_value * value, void * arg);
+
+/**
+ * The matcher object to extract selected values from a token stream.
+ */
+struct json5_matcher {
+	json5_matcher_path * paths;  ///< Compiled paths.
+	size_t paths_len;            ///< Number of paths.
+	json5_matcher_frame * stack; ///< Open containers.
+	size_t stack_len;            ///< Number of open containers.
+	size_t stack_cap;            ///< Stack capacity.
+	uint64_t next_mask;          ///< Paths matching the next value.
+	json5_value * next_value;    ///< Capture target of the next value.
+	size_t capture_depth;        ///< Stack depth of captured container.
+	size_t capture_path;         ///< Path index of the current capture.
+	json5_value capture;         ///< Captured value for callbacks.
+	json5_value * result;        ///< Result object.
+	json5_matcher_func func;     ///< Match callback.
+	void * func_arg;             ///< Match callback argument.
+};
+
+/**
+ * Initialize a matcher.
+ *
+ * @param matcher The matcher to initialize.
+ *
+ * @return 0 on success.
+ */
+extern int json5_matcher_init (json5_matcher * matcher);
+
+/**
+ * Destroy a matcher.
+ *
+ * @param matcher The matcher to destroy.
+ */
+extern void json5_matcher_destroy (json5_matcher * matcher);
+
+/**
+ * Compile and add a path. Segments are separated by `.`; array indexes and
+ * quoted keys are given in brackets, e.g. `items[*].price`, `user.id` or
+ * `meta["a.b"]`. `*` matches any key or index.
+ *
+ * If several paths select the same value, it is only reported for the path
+ * added first. Paths inside an already matched container are not reported
+ * separately.
+ *
+ * @param matcher The matcher to add the path to.
+ * @param path The path to compile.
+ * @param path_len The path length in bytes. If -1, `strlen` is used.
+ *
+ * @return The path index on success otherwise -1 if the path is invalid, the
+ * maximum number of paths is reached or an allocation error occured.
+ */
+extern ssize_t json5_matcher_add_path (json5_matcher * matcher, char const * path, size_t path_len);
+
+/**
+ * Set a callback function called for every matched value instead of filling
+ * a result object.
+ *
+ * @param matcher The matcher.
+ * @param func The callback function or `NULL` to fill a result object.
+ * @param arg The user argument passed to @p func.
+ */
+extern void json5_matcher_set_func (json5_matcher * matcher, json5_matcher_func func, void * arg);
+
+/**
+ * Decode @p string and extract all values matching the added paths. Values
+ * not matching any path are only validated, but not built.
+ *
+ * If no callback is set, @p out_result is set to an object with the path
+ * names as keys. Paths containing wildcards are set to arrays containing all
+ * matches. Paths not found in the input are not set.
+ *
+ * @param matcher The matcher.
+ * @param coder The coder used for tokenizing and parsing.
+ * @param string The string to decode.
+ * @param size The string size in bytes.
+ * @param out_result The result object. Can be `NULL` if a callback is set.
+ *
+ * @return 0 on success otherwise a value != 0 if a syntax or allocation error
+ * occured or the callback function aborted.
+ */
+extern int json5_matcher_match (json5_matcher * matcher, json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_result);
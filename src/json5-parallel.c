@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json5-parallel.h"
+
+/**
+ * Defines a range of root array items parsed by a single thread
+ */
+typedef struct {
+	uint8_t const * chars;
+	uint8_t const * end;
+	json5_parser const * settings; ///< The parser to copy limits, duplicate key policy and key set from.
+	size_t values;                 ///< Number of values counted against the limits.
+	size_t bytes;                  ///< Size of values counted against the limits.
+	json5_value value;
+	int res;
+} json5_parallel_range;
+
+/**
+ * Check if @p chars starts with a line terminator
+ */
+static int json5_parallel_is_linebreak (uint8_t const * chars, uint8_t const * end) {
+	switch (chars [0]) {
+		case '\n':
+		case '\r': {
+			return 1;
+			break;
+		}
+		case 0xE2: {
+			// paragraph separator U+2029
+			return end - chars >= 3 && chars [1] == 0x80 && chars [2] == 0xA9;
+			break;
+		}
+		default: {
+			return 0;
+			break;
+		}
+	}
+}
+
+/**
+ * Skip whitespace and comments
+ *
+ * Returns a pointer to the next character or NULL if a comment is not closed.
+ */
+static uint8_t const * json5_parallel_skip_space (uint8_t const * chars, uint8_t const * end) {
+	while (chars < end) {
+		switch (*chars) {
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+			case '\v':
+			case '\f': {
+				chars ++;
+				break;
+			}
+			case '/': {
+				if (end - chars < 2) {
+					return chars;
+				}
+
+				if (chars [1] == '/') {
+					for (chars += 2; chars < end && !json5_parallel_is_linebreak (chars, end); chars ++) {
+					}
+				}
+				else if (chars [1] == '*') {
+					for (chars += 2; ; chars ++) {
+						if (end - chars < 2) {
+							return NULL;
+						}
+
+						if (chars [0] == '*' && chars [1] == '/') {
+							chars += 2;
+							break;
+						}
+					}
+				}
+				else {
+					return chars;
+				}
+				break;
+			}
+			default: {
+				return chars;
+				break;
+			}
+		}
+	}
+
+	return chars;
+}
+
+/**
+ * Find the commas between the root array items
+ *
+ * Strings and comments are skipped. Splits the array into at most @p count
+ * ranges of similar size. Returns the number of ranges or 0 if the string
+ * does not contain a root array or is malformed.
+ */
+static size_t json5_parallel_scan (uint8_t const * chars, uint8_t const * end, json5_parallel_range * ranges, size_t count) {
+	int quote;
+	size_t depth = 1;
+	size_t len = 0;
+	size_t range_size;
+	int has_item = 0;
+	uint8_t const * start;
+	uint8_t const * next_split;
+
+	if (!(chars = json5_parallel_skip_space (chars, end)) || chars >= end || *chars != '[') {
+		return 0;
+	}
+
+	start = ++ chars;
+	range_size = (end - chars) / count;
+	next_split = chars + range_size;
+
+	while (depth) {
+		if (!(chars = json5_parallel_skip_space (chars, end)) || chars >= end) {
+			return 0;
+		}
+
+		switch (*chars) {
+			case '[':
+			case '{': {
+				depth ++;
+				break;
+			}
+			case ']':
+			case '}': {
+				depth --;
+				break;
+			}
+			case '\'':
+			case '"': {
+				quote = *chars;
+
+				for (chars ++; chars < end && *chars != quote; chars ++) {
+					if (*chars == '\\' && end - chars > 1) {
+						chars ++;
+					}
+				}
+
+				if (chars >= end) {
+					return 0;
+				}
+				break;
+			}
+			case ',': {
+				if (depth > 1) {
+					break;
+				}
+
+				// empty item
+				if (!has_item) {
+					return 0;
+				}
+
+				has_item = 0;
+
+				if (chars >= next_split && len < count - 1) {
+					ranges [len].chars = start;
+					ranges [len].end = chars;
+					len ++;
+					start = chars + 1;
+					next_split = chars + range_size;
+				}
+
+				chars ++;
+				continue;
+				break;
+			}
+			default: {
+				break;
+			}
+		}
+
+		has_item = 1;
+		chars ++;
+	}
+
+	// only whitespace and comments may follow the root array
+	if (json5_parallel_skip_space (chars, end) != end) {
+		return 0;
+	}
+
+	ranges [len].chars = start;
+	ranges [len].end = chars - 1;
+	len ++;
+
+	return len;
+}
+
+static void * json5_parallel_parse (void * arg) {
+	json5_parallel_range * range = arg;
+	json5_coder coder;
+	uint8_t const open [] = "[";
+	uint8_t const close [] = "]";
+	uint8_t const * chars;
+
+	range -> res = -1;
+
+	if (json5_coder_init (&coder) != 0) {
+		return NULL;
+	}
+
+	json5_coder_set_limits (&coder, &range -> settings -> limits);
+	json5_coder_set_dup_policy (&coder, range -> settings -> dup_policy);
+	json5_coder_set_keyset (&coder, range -> settings -> keyset);
+
+	chars = open;
+
+	if (json5_parser_decode_tokens (&coder.parser, &coder.tknzr, &chars, &open [1], 0, SIZE_MAX) < 0) {
+		goto cleanup;
+	}
+
+	if (json5_parser_decode_tokens (&coder.parser, &coder.tknzr, &range -> chars, range -> end, 0, SIZE_MAX) < 0) {
+		goto cleanup;
+	}
+
+	chars = close;
+
+	if (json5_parser_decode_tokens (&coder.parser, &coder.tknzr, &chars, &close [1], 1, SIZE_MAX) < 0) {
+		goto cleanup;
+	}
+
+	range -> res = json5_coder_take_value (&coder, &range -> value);
+	range -> values = coder.parser.values;
+	range -> bytes = coder.parser.bytes;
+
+	cleanup: {
+		json5_coder_destroy (&coder);
+
+		return NULL;
+	}
+}
+
+/**
+ * Check the limits counted per range against the whole string
+ *
+ * The opening bracket of the root array is counted by every range. Returns
+ * 0 if no limit is exceeded or -1 otherwise.
+ */
+static int json5_parallel_check_limits (json5_parser const * parser, json5_parallel_range const * ranges, size_t count) {
+	json5_limits const * limits = &parser -> limits;
+	size_t values = 0;
+	size_t bytes = 0;
+
+	for (size_t i = 0; i < count; i ++) {
+		values += ranges [i].values;
+		bytes += ranges [i].bytes;
+	}
+
+	if (limits -> max_values && values - (count - 1) > limits -> max_values) {
+		return -1;
+	}
+
+	if (limits -> max_bytes && bytes - (count - 1) * sizeof (json5_value) > limits -> max_bytes) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Move the items of all ranges into the first range
+ */
+static int json5_parallel_join (json5_parallel_range * ranges, size_t count) {
+	size_t len = 0;
+	json5_value * array = &ranges [0].value;
+
+	for (size_t i = 0; i < count; i ++) {
+		len += ranges [i].value.len;
+	}
+
+	if (json5_value_reserve (array, len) != 0) {
+		return -1;
+	}
+
+	for (size_t i = 1; i < count; i ++) {
+		json5_value * range = &ranges [i].value;
+
+		memcpy (&array -> items [array -> len], range -> items, range -> len * sizeof (*range -> items));
+		array -> len += range -> len;
+		range -> len = 0;
+	}
+
+	return 0;
+}
+
+int json5_parallel_decode (json5_coder * coder, uint8_t const * string, size_t size, size_t threads, json5_value * out_value) {
+	int res = 0;
+	size_t count;
+	size_t started = 0;
+	pthread_t thread_ids [JSON5_PARALLEL_MAX_THREADS];
+	json5_parallel_range ranges [JSON5_PARALLEL_MAX_THREADS];
+
+	if (threads > JSON5_PARALLEL_MAX_THREADS) {
+		threads = JSON5_PARALLEL_MAX_THREADS;
+	}
+
+	if (threads > size / JSON5_PARALLEL_MIN_RANGE) {
+		threads = size / JSON5_PARALLEL_MIN_RANGE;
+	}
+
+	if (threads < 2 || !(count = json5_parallel_scan (string, &string [size], ranges, threads)) || count < 2) {
+		return json5_coder_decode (coder, string, size, out_value);
+	}
+
+	for (size_t i = 0; i < count; i ++) {
+		ranges [i].settings = &coder -> parser;
+		ranges [i].value = JSON5_VALUE_INIT;
+	}
+
+	// parse first range on calling thread
+	for (started = 1; started < count; started ++) {
+		if (pthread_create (&thread_ids [started], NULL, json5_parallel_parse, &ranges [started]) != 0) {
+			break;
+		}
+	}
+
+	json5_parallel_parse (&ranges [0]);
+
+	for (size_t i = 1; i < started; i ++) {
+		pthread_join (thread_ids [i], NULL);
+	}
+
+	// parse remaining ranges if not all threads could be started
+	for (size_t i = started; i < count; i ++) {
+		json5_parallel_parse (&ranges [i]);
+	}
+
+	for (size_t i = 0; i < count; i ++) {
+		if (ranges [i].res != 0) {
+			res = -1;
+		}
+	}
+
+	if (res == 0 && json5_parallel_check_limits (&coder -> parser, ranges, count) == 0 && json5_parallel_join (ranges, count) == 0) {
+		json5_coder_reset (coder);
+		json5_value_set_null (out_value);
+		*out_value = ranges [0].value;
+		ranges [0].value = JSON5_VALUE_INIT;
+	}
+	else {
+		// decode again to get error position or exceeded limit
+		res = json5_coder_decode (coder, string, size, out_value);
+	}
+
+	for (size_t i = 0; i < count; i ++) {
+		json5_value_set_null (&ranges [i].value);
+	}
+
+	return res;
+}
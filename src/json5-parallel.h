@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+
+/**
+ * Minimum number of bytes parsed by a single thread.
+ */
+#define JSON5_PARALLEL_MIN_RANGE (256 * 1024)
+
+/**
+ * Maximum number of threads used by `json5_parallel_decode`.
+ */
+#define JSON5_PARALLEL_MAX_THREADS 256
+
+/**
+ * Decode a JSON string containing a large root array with multiple threads
+ *
+ * The root array is split into ranges of items at the commas between items.
+ * Each range is parsed by its own thread and coder, and the partial arrays
+ * are joined. At most @p threads threads are used including the calling
+ * thread, but each range contains at least `JSON5_PARALLEL_MIN_RANGE` bytes.
+ *
+ * Strings not containing an array as root value are decoded with @p coder on
+ * the calling thread. If a range contains an error, the string is decoded
+ * again with @p coder, so the error position refers to the original string.
+ *
+ * The ranges are parsed with the limits, duplicate key policy and key set of
+ * @p coder. The maximum number of values and bytes apply to the whole string.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_parallel_decode (json5_coder * coder, uint8_t const * string, size_t size, size_t threads, json5_value * out_value);
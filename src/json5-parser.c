@@ -28,6 +28,8 @@
 #include "json5-parser.h"
 
 #define INIT_STACK_CAP 32
+#define INIT_KEYS_CAP 64
+#define INIT_SEEN_CAP 64
 
 /**
  * Defines parser states
@@ -111,6 +113,176 @@ static json5_parser_item * json5_parser_stack_pop (json5_parser * parser)
 	return &parser -> stack [parser -> stack_len - 1];
 }
 
+static int json5_parser_push_key (json5_parser * parser, uint8_t const * key)
+{
+	uint8_t const ** keys;
+	size_t new_cap;
+
+	if (parser -> keys_len >= parser -> keys_cap) {
+		new_cap = parser -> keys_cap * 2;
+
+		if (new_cap < INIT_KEYS_CAP) {
+			new_cap = INIT_KEYS_CAP;
+		}
+
+		keys = realloc (parser -> keys, new_cap * sizeof (*keys));
+
+		if (!keys) {
+			return -1;
+		}
+
+		parser -> keys = keys;
+		parser -> keys_cap = new_cap;
+	}
+
+	parser -> keys [parser -> keys_len ++] = key;
+
+	return 0;
+}
+
+static size_t json5_parser_seen_slot (uint8_t const * key, size_t object, size_t mask)
+{
+	return (size_t) ((((uintptr_t) key >> 3) + object * 0x85EBCA77u) * 0x9E3779B1u) & mask;
+}
+
+/**
+ * Add key to the set of keys seen in reused objects
+ *
+ * Interned keys are shared by all objects of a document, so keys are
+ * compared by address together with the number of the object containing
+ * them. Returns 1 if the key was already seen in @p object, 0 if it was
+ * added or -1 if an allocation error occurred.
+ */
+static int json5_parser_see_key (json5_parser * parser, uint8_t const * key, size_t object)
+{
+	size_t i, mask;
+	size_t new_cap;
+	json5_parser_seen * seen;
+	json5_parser_seen const * entry;
+
+	if (parser -> seen_len * 2 >= parser -> seen_cap) {
+		new_cap = parser -> seen_cap * 2;
+
+		if (new_cap < INIT_SEEN_CAP) {
+			new_cap = INIT_SEEN_CAP;
+		}
+
+		if (!(seen = calloc (new_cap, sizeof (*seen)))) {
+			return -1;
+		}
+
+		mask = new_cap - 1;
+
+		for (size_t j = 0; j < parser -> seen_cap; j ++) {
+			entry = &parser -> seen [j];
+
+			if (entry -> key) {
+				for (i = json5_parser_seen_slot (entry -> key, entry -> object, mask); seen [i].key; i = (i + 1) & mask) {
+				}
+
+				seen [i] = *entry;
+			}
+		}
+
+		free (parser -> seen);
+		parser -> seen = seen;
+		parser -> seen_cap = new_cap;
+	}
+
+	mask = parser -> seen_cap - 1;
+
+	for (i = json5_parser_seen_slot (key, object, mask); parser -> seen [i].key; i = (i + 1) & mask) {
+		if (parser -> seen [i].key == key && parser -> seen [i].object == object) {
+			return 1;
+		}
+	}
+
+	parser -> seen [i].key = key;
+	parser -> seen [i].object = object;
+	parser -> seen_len ++;
+
+	return 0;
+}
+
+static int json5_parser_compare_keys (void const * a, void const * b)
+{
+	uintptr_t key_a = (uintptr_t) *(uint8_t const * const *) a;
+	uintptr_t key_b = (uintptr_t) *(uint8_t const * const *) b;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * Remove items and properties of a reused container not set again
+ */
+static void json5_parser_end_container (json5_parser * parser, json5_parser_item * item)
+{
+	size_t count;
+	size_t distinct;
+	json5_value * value = item -> value;
+	uint8_t const ** keys;
+
+	// skipped value
+	if (!value) {
+		return;
+	}
+
+	if (value -> type == JSON5_TYPE_ARRAY) {
+		for (size_t i = value -> len; i < item -> old_len; i ++) {
+			json5_value_set_null (&value -> items [i]);
+		}
+
+		item -> old_len = 0;
+	}
+	else if (value -> type == JSON5_TYPE_OBJECT) {
+		// new objects contain only keys set by the document
+		if (item -> old_len) {
+			keys = &parser -> keys [item -> keys_base];
+			count = parser -> keys_len - item -> keys_base;
+
+			// keep the source order like new objects; the previous order
+			// is kept if this fails
+			json5_value_order_props (value, keys, count);
+
+			qsort (keys, count, sizeof (*keys), json5_parser_compare_keys);
+			distinct = count > 0;
+
+			for (size_t i = 1; i < count; i ++) {
+				distinct += keys [i] != keys [i - 1];
+			}
+
+			if (value -> len > distinct) {
+				json5_value_retain_props (value, keys, count);
+			}
+		}
+
+		parser -> keys_len = item -> keys_base;
+
+		// the object is kept as property table if this fails
+		if (parser -> keyset) {
+			json5_value_use_keyset (value, parser -> keyset);
+		}
+	}
+}
+
+/**
+ * Remove items of reused arrays not set again when decoding stopped early
+ *
+ * The items are not part of the array anymore and would leak otherwise.
+ */
+static void json5_parser_drop_reused (json5_parser * parser)
+{
+	json5_parser_item * item;
+
+	for (size_t i = 0; i < parser -> stack_len; i ++) {
+		item = &parser -> stack [i];
+
+		if (item -> old_len && item -> value && item -> value -> type == JSON5_TYPE_ARRAY) {
+			json5_parser_end_container (parser, item);
+		}
+	}
+}
+
 static void json5_parser_set_error (json5_parser * parser, char const * msg, ...)
 {
 	va_list args;
@@ -150,8 +322,28 @@ void json5_parser_reset (json5_parser * parser)
 	json5_parser_item * stack = parser -> stack;
 	json5_parser_funcs const * funcs = parser -> funcs;
 	void * funcs_arg = parser -> funcs_arg;
+	json5_parser_value_func item_func = parser -> item_func;
+	void * item_arg = parser -> item_arg;
+	size_t item_depth = parser -> item_depth;
+	json5_limits limits = parser -> limits;
+	json5_dup_policy dup_policy = parser -> dup_policy;
+	json5_keyset const * keyset = parser -> keyset;
 	json5_parser_item * item;
 	size_t stack_cap = parser -> stack_cap;
+	uint8_t const ** keys = parser -> keys;
+	size_t keys_cap = parser -> keys_cap;
+	json5_parser_seen * seen = parser -> seen;
+	size_t seen_cap = parser -> seen_cap;
+	json5_key_table interned = parser -> interned;
+
+	if (parser -> seen_len) {
+		memset (seen, 0, seen_cap * sizeof (*seen));
+	}
+
+	json5_parser_drop_reused (parser);
+
+	// keys stay valid as long as decoded values use them
+	json5_key_table_clear (&interned);
 
 	json5_value_set_null (&parser -> value);
 	json5_value_set_null (&parser -> error);
@@ -161,6 +353,17 @@ void json5_parser_reset (json5_parser * parser)
 	parser -> stack_cap = stack_cap;
 	parser -> funcs = funcs;
 	parser -> funcs_arg = funcs_arg;
+	parser -> item_func = item_func;
+	parser -> item_arg = item_arg;
+	parser -> item_depth = item_depth;
+	parser -> limits = limits;
+	parser -> dup_policy = dup_policy;
+	parser -> keyset = keyset;
+	parser -> keys = keys;
+	parser -> keys_cap = keys_cap;
+	parser -> seen = seen;
+	parser -> seen_cap = seen_cap;
+	parser -> interned = interned;
 
 	item = json5_parser_stack_push (parser);
 
@@ -170,10 +373,16 @@ void json5_parser_reset (json5_parser * parser)
 
 void json5_parser_destroy (json5_parser * parser)
 {
+	json5_parser_drop_reused (parser);
+
 	if (parser -> stack) {
 		free (parser -> stack);
 	}
 
+	free (parser -> keys);
+	free (parser -> seen);
+	json5_key_table_destroy (&parser -> interned);
+
 	json5_value_set_null (&parser -> value);
 	json5_value_set_null (&parser -> error);
 
@@ -181,77 +390,496 @@ void json5_parser_destroy (json5_parser * parser)
 	memset (parser, 0, sizeof (*parser));
 }
 
+int json5_parser_trim (json5_parser * parser, size_t max_size)
+{
+	int res = 0;
+	json5_parser_item * stack;
+
+	if (parser -> keys_cap * sizeof (*parser -> keys) > max_size) {
+		json5_parser_reset (parser);
+		free (parser -> keys);
+		parser -> keys = NULL;
+		parser -> keys_cap = 0;
+		res = 1;
+	}
+
+	if (parser -> seen_cap * sizeof (*parser -> seen) > max_size) {
+		json5_parser_reset (parser);
+		free (parser -> seen);
+		parser -> seen = NULL;
+		parser -> seen_cap = 0;
+		res = 1;
+	}
+
+	if (parser -> interned.cap * sizeof (*parser -> interned.keys) > max_size) {
+		json5_parser_reset (parser);
+		json5_key_table_destroy (&parser -> interned);
+		res = 1;
+	}
+
+	if (parser -> stack_cap * sizeof (*stack) <= max_size || parser -> stack_cap <= INIT_STACK_CAP) {
+		return res;
+	}
+
+	json5_parser_reset (parser);
+
+	if (!(stack = realloc (parser -> stack, INIT_STACK_CAP * sizeof (*stack)))) {
+		return res;
+	}
+
+	parser -> stack = stack;
+	parser -> stack_cap = INIT_STACK_CAP;
+
+	return 1;
+}
+
 static void json5_parser_print_token_error (json5_parser * parser, json5_token const * token)
 {
-	char const * name = NULL;
-	char const * value = NULL;
+	char error [128];
 
-	switch (token -> type) {
-		case JSON5_TOK_OBJ_OPEN: {
-			value = "{";
-			break;
-		}
-		case JSON5_TOK_OBJ_CLOSE: {
-			value = "}";
-			break;
+	json5_token_format_error (token, error, sizeof (error));
+	json5_parser_set_error (parser, "%s", error);
+}
+
+/**
+ * Account a value or key token against the parser limits
+ *
+ * Has to be called before a container is opened. Returns 0 if no limit is
+ * exceeded or -1 otherwise.
+ */
+static int json5_parser_check_limits (json5_parser * parser, json5_token const * token, int is_key)
+{
+	json5_limits const * limits = &parser -> limits;
+	size_t size = sizeof (json5_value);
+
+	if (is_key) {
+		size = sizeof (json5_obj_prop) - sizeof (json5_value) + token -> length + 1;
+	}
+	else {
+		switch (token -> type) {
+			case JSON5_TOK_ARR_OPEN:
+			case JSON5_TOK_OBJ_OPEN: {
+				if (limits -> max_depth && parser -> depth >= limits -> max_depth) {
+					json5_parser_set_error (parser, "Maximum depth of %zu exceeded on line %d:%d",
+						limits -> max_depth, token -> offset.lineno + 1, token -> offset.colno);
+					return -1;
+				}
+				break;
+			}
+			case JSON5_TOK_STRING: {
+				size += token -> length + 1;
+				break;
+			}
+			default: {
+				break;
+			}
 		}
-		case JSON5_TOK_ARR_OPEN: {
-			value = "[";
-			break;
+
+		if (limits -> max_values && ++ parser -> values > limits -> max_values) {
+			json5_parser_set_error (parser, "Maximum number of %zu values exceeded on line %d:%d",
+				limits -> max_values, token -> offset.lineno + 1, token -> offset.colno);
+			return -1;
 		}
-		case JSON5_TOK_COMMA: {
-			value = ",";
+	}
+
+	if (limits -> max_string_len && token -> length > limits -> max_string_len && (is_key || token -> type == JSON5_TOK_STRING)) {
+		json5_parser_set_error (parser, "String exceeds maximum length of %zu bytes on line %d:%d",
+			limits -> max_string_len, token -> offset.lineno + 1, token -> offset.colno);
+		return -1;
+	}
+
+	parser -> bytes += size;
+
+	if (limits -> max_bytes && parser -> bytes > limits -> max_bytes) {
+		json5_parser_set_error (parser, "Maximum size of %zu bytes exceeded on line %d:%d",
+			limits -> max_bytes, token -> offset.lineno + 1, token -> offset.colno);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Pass completed array item to `item_func` and remove it from the array
+ */
+static int json5_parser_put_item (json5_parser * parser, json5_parser_item const * item)
+{
+	int res;
+	json5_value * array;
+
+	if (!parser -> item_func || parser -> funcs) {
+		return 0;
+	}
+
+	if (!item || !item -> value || item -> state != JSON5_STATE_ARR_SEP || parser -> depth != parser -> item_depth + 1) {
+		return 0;
+	}
+
+	array = item -> value;
+	res = parser -> item_func (&array -> items [array -> len - 1], parser -> item_arg);
+
+	// reuse item storage for next item
+	json5_value_set_null (&array -> items [array -> len - 1]);
+	array -> len --;
+
+	return res;
+}
+
+/**
+ * Build the value tree from a single token
+ *
+ * Used if no parser callback functions are set. @p item_ref points to the
+ * top stack item and is updated when the stack changes.
+ */
+static int json5_parser_build_token (json5_parser * parser, json5_parser_item ** item_ref, json5_token const * token)
+{
+	json5_parser_item * item = *item_ref;
+	json5_value * value;
+
+	switch (item -> state) {
+		case JSON5_STATE_NONE: {
+			item -> state = JSON5_STATE_ROOT;
+			value = item -> value;
+			goto value;
 			break;
 		}
-		case JSON5_TOK_COLON: {
-			value = ":";
+		case JSON5_STATE_ROOT: {
+			switch (token -> type) {
+				case JSON5_TOK_END: {
+					item -> state = JSON5_STATE_END;
+					break;
+				}
+				default: {
+					goto extra_token;
+					break;
+				}
+			}
+
 			break;
 		}
-		case JSON5_TOK_STRING: {
-			name = "string";
+		case JSON5_STATE_ARR_VAL: {
+			if (token -> type == JSON5_TOK_ARR_CLOSE) {
+				goto container_end;
+			}
+
+			item -> state = JSON5_STATE_ARR_SEP;
+			value = item -> value;
+
+			// reuse items of existing array
+			if (!value) {
+				// skipped value
+			}
+			else if (value -> len < item -> old_len) {
+				value = &value -> items [value -> len ++];
+			}
+			else if (!(value = json5_value_append_item (value))) {
+				goto alloc_error;
+			}
+
+			goto value;
 			break;
 		}
-		case JSON5_TOK_NUMBER:
-		case JSON5_TOK_NUMBER_FLOAT:
-		case JSON5_TOK_NUMBER_BOOL: {
-			name = "number";
+		case JSON5_STATE_ARR_SEP: {
+			switch (token -> type) {
+				case JSON5_TOK_COMMA: {
+					item -> state = JSON5_STATE_ARR_VAL;
+					break;
+				}
+				case JSON5_TOK_ARR_CLOSE: {
+					goto container_end;
+					break;
+				}
+				default: {
+					goto unexpected_token;
+					break;
+				}
+			}
+
 			break;
 		}
-		case JSON5_TOK_NAME: {
-			name = "identifier";
+		case JSON5_STATE_OBJ_KEY: {
+			switch (token -> type) {
+				case JSON5_TOK_NAME:
+				case JSON5_TOK_STRING:
+				case JSON5_TOK_NUMBER_BOOL:
+				case JSON5_TOK_NULL:
+				case JSON5_TOK_NAN:
+				case JSON5_TOK_INFINITY: {
+					int exists;
+					json5_value * prop_value;
+					uint8_t const * key;
+
+					item -> state = JSON5_STATE_OBJ_SEP;
+
+					if (json5_parser_check_limits (parser, token, 1) != 0) {
+						goto error;
+					}
+
+					value = NULL;
+
+					if (item -> value) {
+						if (!(prop_value = json5_value_intern_value (item -> value, &parser -> interned, (char *) token -> token, token -> length, &key, &exists))) {
+							goto alloc_error;
+						}
+
+						// keys of reused objects may exist from a previous document
+						if (parser -> dup_policy != JSON5_DUP_LAST && item -> old_len) {
+							if ((exists = json5_parser_see_key (parser, key, item -> object)) < 0) {
+								goto alloc_error;
+							}
+						}
+
+						if (!exists || parser -> dup_policy == JSON5_DUP_LAST) {
+							if (json5_parser_push_key (parser, key) != 0) {
+								goto alloc_error;
+							}
+
+							value = prop_value;
+						}
+						else if (parser -> dup_policy == JSON5_DUP_REJECT) {
+							goto duplicate_key;
+						}
+					}
+
+					if (!(item = json5_parser_stack_push (parser))) {
+						goto alloc_error;
+					}
+
+					item -> state = JSON5_STATE_OBJ_KEY_SEP;
+					item -> value = value;
+					break;
+				}
+				case JSON5_TOK_OBJ_CLOSE: {
+					goto container_end;
+					break;
+				}
+				default: {
+					goto unexpected_token;
+					break;
+				}
+			}
+
 			break;
 		}
-		case JSON5_TOK_INFINITY: {
-			value = "Infinity";
+		case JSON5_STATE_OBJ_KEY_SEP: {
+			switch (token -> type) {
+				case JSON5_TOK_COLON: {
+					item -> state = JSON5_STATE_OBJ_VAL;
+					break;
+				}
+				default: {
+					goto unexpected_token;
+					break;
+				}
+			}
+
 			break;
 		}
-		case JSON5_TOK_NAN: {
-			value = "NaN";
+		case JSON5_STATE_OBJ_VAL: {
+			// the key item becomes the container item or is removed
+			value = item -> value;
+			parser -> stack_len --;
+			item = &parser -> stack [parser -> stack_len - 1];
+			goto value;
 			break;
 		}
-		case JSON5_TOK_NULL: {
-			value = "null";
+		case JSON5_STATE_OBJ_SEP: {
+			switch (token -> type) {
+				case JSON5_TOK_COMMA: {
+					item -> state = JSON5_STATE_OBJ_KEY;
+					break;
+				}
+				case JSON5_TOK_OBJ_CLOSE: {
+					goto container_end;
+					break;
+				}
+				default: {
+					goto unexpected_token;
+					break;
+				}
+			}
+
 			break;
 		}
-		case JSON5_TOK_END: {
-			json5_parser_set_error (parser, "Premature end of file");
-			return;
+		case JSON5_STATE_END: {
 			break;
 		}
 		default: {
+			goto error;
 			break;
 		}
 	}
 
-	if (name) {
-		json5_parser_set_error (parser, "Unexpected %s on line %d:%d",
-			name, token -> offset.lineno + 1, token -> offset.colno);
+	*item_ref = item;
+
+	return 0;
+
+	value: {
+		if (json5_parser_check_limits (parser, token, 0) != 0) {
+			goto error;
+		}
+
+		if (!value) {
+			goto skip_value;
+		}
+
+		switch (token -> type) {
+			case JSON5_TOK_STRING: {
+				json5_value_set_string (value, (char *) token -> token, token -> length);
+				break;
+			}
+			case JSON5_TOK_NUMBER: {
+				json5_value_set_int (value, token -> value.i);
+				break;
+			}
+			case JSON5_TOK_NUMBER_FLOAT: {
+				json5_value_set_float (value, token -> value.f);
+				break;
+			}
+			case JSON5_TOK_NUMBER_BOOL: {
+				json5_value_set_bool (value, token -> value.i != 0);
+				break;
+			}
+			case JSON5_TOK_NULL: {
+				json5_value_set_null (value);
+				break;
+			}
+			case JSON5_TOK_NAN: {
+				json5_value_set_nan (value);
+				break;
+			}
+			case JSON5_TOK_INFINITY: {
+				json5_value_set_infinity (value, (int) token -> value.i);
+				break;
+			}
+			case JSON5_TOK_ARR_OPEN: {
+				json5_value_set_array (value);
+
+				if (!(item = json5_parser_stack_push (parser))) {
+					goto alloc_error;
+				}
+
+				// items of an existing array are overwritten
+				item -> state = JSON5_STATE_ARR_VAL;
+				item -> value = value;
+				item -> old_len = value -> len;
+				value -> len = 0;
+				parser -> depth ++;
+				*item_ref = item;
+
+				return 0;
+				break;
+			}
+			case JSON5_TOK_OBJ_OPEN: {
+				json5_value_set_object (value);
+
+				if (!(item = json5_parser_stack_push (parser))) {
+					goto alloc_error;
+				}
+
+				// keys set again are collected to remove the others
+				item -> state = JSON5_STATE_OBJ_KEY;
+				item -> value = value;
+				item -> old_len = value -> len;
+				item -> keys_base = parser -> keys_len;
+				item -> object = parser -> objects ++;
+				parser -> depth ++;
+				*item_ref = item;
+
+				return 0;
+				break;
+			}
+			default: {
+				goto unexpected_token;
+				break;
+			}
+		}
+
+		goto put_item;
 	}
-	else {
-		json5_parser_set_error (parser, "Unexpected '%s' on line %d:%d",
-			value, token -> offset.lineno + 1, token -> offset.colno);
+
+	skip_value: {
+		switch (token -> type) {
+			case JSON5_TOK_STRING:
+			case JSON5_TOK_NUMBER:
+			case JSON5_TOK_NUMBER_FLOAT:
+			case JSON5_TOK_NUMBER_BOOL:
+			case JSON5_TOK_NULL:
+			case JSON5_TOK_NAN:
+			case JSON5_TOK_INFINITY: {
+				break;
+			}
+			case JSON5_TOK_ARR_OPEN:
+			case JSON5_TOK_OBJ_OPEN: {
+				// containers are only validated
+				if (!(item = json5_parser_stack_push (parser))) {
+					goto alloc_error;
+				}
+
+				item -> state = token -> type == JSON5_TOK_ARR_OPEN ? JSON5_STATE_ARR_VAL : JSON5_STATE_OBJ_KEY;
+				item -> value = NULL;
+				parser -> depth ++;
+				*item_ref = item;
+
+				return 0;
+				break;
+			}
+			default: {
+				goto unexpected_token;
+				break;
+			}
+		}
+
+		goto put_item;
+	}
+
+	container_end: {
+		json5_parser_end_container (parser, item);
+		parser -> depth --;
+		item = json5_parser_stack_pop (parser);
+		goto put_item;
+	}
+
+	put_item: {
+		*item_ref = item;
+
+		if (json5_parser_put_item (parser, item) != 0) {
+			goto error;
+		}
+
+		return 0;
+	}
+
+	unexpected_token: {
+		json5_parser_print_token_error (parser, token);
+		goto error;
 	}
 
+	alloc_error: {
+		json5_parser_set_error (parser, "Allocation error");
+		goto error;
+	}
+
+	extra_token: {
+		json5_parser_set_error (parser, "Extra token in root context on line %d:%d",
+			token -> offset.lineno + 1, token -> offset.colno);
+		goto error;
+	}
+
+	duplicate_key: {
+		json5_parser_set_error (parser, "Duplicate key '%.*s' on line %d:%d",
+			(int) (token -> length < 64 ? token -> length : 64), token -> token,
+			token -> offset.lineno + 1, token -> offset.colno);
+		goto error;
+	}
+
+	error: {
+		item = json5_parser_stack_top (parser);
+		item -> state = JSON5_STATE_ERROR;
+		*item_ref = item;
+
+		return -1;
+	}
 }
 
 int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens, size_t count)
@@ -259,12 +887,21 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 	int res = 0;
 	json5_token const * token = NULL;
 	json5_parser_item * item;
-	json5_value * value;
 	json5_parser_funcs const * funcs = parser -> funcs;
 	void * funcs_arg = parser -> funcs_arg;
 
 	item = json5_parser_stack_top (parser);
 
+	if (!funcs) {
+		for (size_t i = 0; i < count; i ++) {
+			if (json5_parser_build_token (parser, &item, &tokens [i]) != 0) {
+				return -1;
+			}
+		}
+
+		return 0;
+	}
+
 	for (size_t i = 0; i < count; i ++) {
 		token = &tokens [i];
 
@@ -331,17 +968,8 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 
 				switch (token -> type) {
 					case JSON5_TOK_ARR_OPEN: {
-						value = item -> value;
-
-						if (funcs) {
-							if (funcs -> begin_index (token, funcs_arg) != 0) {
-								goto error;
-							}
-						}
-						else {
-							if (!(value = json5_value_append_item (item -> value))) {
-								goto alloc_error;
-							}
+						if (funcs -> begin_index (token, funcs_arg) != 0) {
+							goto error;
 						}
 
 						if (!(item = json5_parser_stack_push (parser))) {
@@ -349,7 +977,6 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 						}
 
 						item -> state = JSON5_STATE_ARR_VAL;
-						item -> value = value;
 
 						if (!(item = json5_parser_stack_push (parser))) {
 							goto alloc_error;
@@ -359,17 +986,8 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 						break;
 					}
 					case JSON5_TOK_OBJ_OPEN: {
-						value = item -> value;
-
-						if (funcs) {
-							if (funcs -> begin_index (token, funcs_arg) != 0) {
-								goto error;
-							}
-						}
-						else {
-							if (!(value = json5_value_append_item (item -> value))) {
-								goto alloc_error;
-							}
+						if (funcs -> begin_index (token, funcs_arg) != 0) {
+							goto error;
 						}
 
 						if (!(item = json5_parser_stack_push (parser))) {
@@ -377,7 +995,6 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 						}
 
 						item -> state = JSON5_STATE_OBJ_KEY;
-						item -> value = value;
 
 						if (!(item = json5_parser_stack_push (parser))) {
 							goto alloc_error;
@@ -393,25 +1010,15 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 					case JSON5_TOK_NULL:
 					case JSON5_TOK_NAN:
 					case JSON5_TOK_INFINITY: {
-						value = item -> value;
-
 						if (!(item = json5_parser_stack_push (parser))) {
 							goto alloc_error;
 						}
 
-						if (funcs) {
-							if (funcs -> begin_index (token, funcs_arg) != 0) {
-								goto error;
-							}
-						}
-						else {
-							if (!(value = json5_value_append_item (item -> value))) {
-								goto alloc_error;
-							}
+						if (funcs -> begin_index (token, funcs_arg) != 0) {
+							goto error;
 						}
 
 						item -> state = JSON5_STATE_VALUE;
-						item -> value = value;
 						break;
 					}
 					case JSON5_TOK_ARR_CLOSE: {
@@ -454,17 +1061,12 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 					case JSON5_TOK_NULL:
 					case JSON5_TOK_NAN:
 					case JSON5_TOK_INFINITY: {
-						value = item -> value;
-
-						if (funcs) {
-							if (funcs -> begin_key (token, funcs_arg) != 0) {
-								goto error;
-							}
+						if (json5_parser_check_limits (parser, token, 1) != 0) {
+							goto error;
 						}
-						else {
-							if (!(value = json5_value_set_prop (item -> value, (char *) token -> token, token -> length, 1))) {
-								goto alloc_error;
-							}
+
+						if (funcs -> begin_key (token, funcs_arg) != 0) {
+							goto error;
 						}
 
 						if (!(item = json5_parser_stack_push (parser))) {
@@ -472,7 +1074,6 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 						}
 
 						item -> state = JSON5_STATE_OBJ_KEY_SEP;
-						item -> value = value;
 						break;
 					}
 					case JSON5_TOK_OBJ_CLOSE: {
@@ -575,69 +1176,32 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 		// state actions
 		switch (item -> state) {
 			case JSON5_STATE_VALUE: {
-				if (funcs) {
-					switch (token -> type) {
-						case JSON5_TOK_ARR_OPEN: {
-							if (funcs -> begin_arr (token, funcs_arg) != 0) {
-								goto error;
-							}
-							break;
-						}
-						case JSON5_TOK_OBJ_OPEN: {
-							if (funcs -> begin_obj (token, funcs_arg) != 0) {
-								goto error;
-							}
-							break;
-						}
-						default: {
-							if (funcs -> set_value (token, funcs_arg) != 0) {
-								goto error;
-							}
-							break;
-						}
-					}
+				if (json5_parser_check_limits (parser, token, 0) != 0) {
+					goto error;
 				}
-				else {
-					switch (token -> type) {
-						case JSON5_TOK_STRING: {
-							json5_value_set_string (item -> value, (char *) token -> token, token -> length);
-							break;
-						}
-						case JSON5_TOK_NUMBER: {
-							json5_value_set_int (item -> value, token -> value.i);
-							break;
-						}
-						case JSON5_TOK_NUMBER_FLOAT: {
-							json5_value_set_float (item -> value, token -> value.f);
-							break;
-						}
-						case JSON5_TOK_NUMBER_BOOL: {
-							json5_value_set_bool (item -> value, token -> value.i != 0);
-							break;
-						}
-						case JSON5_TOK_NULL: {
-							json5_value_set_null (item -> value);
-							break;
-						}
-						case JSON5_TOK_NAN: {
-							json5_value_set_nan (item -> value);
-							break;
-						}
-						case JSON5_TOK_INFINITY: {
-							json5_value_set_infinity (item -> value, (int) token -> value.i);
-							break;
-						}
-						case JSON5_TOK_ARR_OPEN: {
-							json5_value_set_array (item -> value);
-							break;
+
+				switch (token -> type) {
+					case JSON5_TOK_ARR_OPEN: {
+						parser -> depth ++;
+
+						if (funcs -> begin_arr (token, funcs_arg) != 0) {
+							goto error;
 						}
-						case JSON5_TOK_OBJ_OPEN: {
-							json5_value_set_object (item -> value);
-							break;
+						break;
+					}
+					case JSON5_TOK_OBJ_OPEN: {
+						parser -> depth ++;
+
+						if (funcs -> begin_obj (token, funcs_arg) != 0) {
+							goto error;
 						}
-						default: {
-							break;
+						break;
+					}
+					default: {
+						if (funcs -> set_value (token, funcs_arg) != 0) {
+							goto error;
 						}
+						break;
 					}
 				}
 
@@ -645,10 +1209,10 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 				break;
 			}
 			case JSON5_STATE_CONTAINER_END: {
-				if (funcs) {
-					if (funcs -> end_container (token, funcs_arg) != 0) {
-						goto error;
-					}
+				parser -> depth --;
+
+				if (funcs -> end_container (token, funcs_arg) != 0) {
+					goto error;
 				}
 
 				item = json5_parser_stack_pop (parser);
@@ -691,11 +1255,97 @@ int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens,
 	}
 }
 
+ssize_t json5_parser_decode_tokens (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const ** chars, uint8_t const * end, int final, size_t max_tokens)
+{
+	int res;
+	size_t count = 0;
+	json5_token const * token;
+	json5_parser_item * item = json5_parser_stack_top (parser);
+
+	while (count < max_tokens) {
+		if ((res = json5_tokenizer_next_token (tknzr, chars, end, final, &token)) <= 0) {
+			if (res < 0) {
+				return -1;
+			}
+
+			break;
+		}
+
+		if (json5_parser_build_token (parser, &item, token) != 0) {
+			return -1;
+		}
+
+		count ++;
+	}
+
+	return count;
+}
+
+int json5_parser_decode (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const * chars, size_t size)
+{
+	uint8_t const * end = &chars [size];
+
+	if (json5_parser_decode_tokens (parser, tknzr, &chars, end, 1, SIZE_MAX) < 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+int json5_parser_decode_into (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_value * value)
+{
+	int res;
+
+	json5_value_transfer (&parser -> value, value);
+	res = json5_parser_decode (parser, tknzr, chars, size);
+
+	// drop remaining items of reused arrays so the tree stays valid
+	if (res != 0) {
+		json5_parser_drop_reused (parser);
+	}
+
+	json5_value_transfer (value, &parser -> value);
+
+	return res;
+}
+
 int json5_parser_is_finished (json5_parser const * parser)
 {
 	return parser -> stack [parser -> stack_len - 1].state >= JSON5_STATE_END;
 }
 
+void json5_parser_set_limits (json5_parser * parser, json5_limits const * limits)
+{
+	if (limits) {
+		parser -> limits = *limits;
+	}
+	else {
+		memset (&parser -> limits, 0, sizeof (parser -> limits));
+	}
+}
+
+void json5_parser_set_dup_policy (json5_parser * parser, json5_dup_policy policy)
+{
+	parser -> dup_policy = policy;
+}
+
+void json5_parser_set_keyset (json5_parser * parser, json5_keyset const * keyset)
+{
+	parser -> keyset = keyset;
+}
+
+void json5_parser_set_item_func (json5_parser * parser, size_t depth, json5_parser_value_func func, void * arg)
+{
+	parser -> item_func = func;
+	parser -> item_arg = arg;
+	parser -> item_depth = depth;
+}
+
+int json5_parser_root_complete (json5_parser const * parser)
+{
+	return parser -> stack_len == 1 && parser -> stack [0].state == JSON5_STATE_ROOT;
+}
+
 int json5_parser_has_error (json5_parser const * parser)
 {
 	return parser -> stack [parser -> stack_len - 1].state == JSON5_STATE_ERROR;
@@ -72,17 +72,72 @@ typedef struct {
 	int (*set_value) (json5_token const * token, void * arg);
 } json5_parser_funcs;
 
+/**
+ * A callback function receiving decoded values.
+ *
+ * The value is cleared after the function returns and can be moved with
+ * `json5_value_transfer`. Returns 0 to continue or a value != 0 to abort.
+ */
+typedef int (*json5_parser_value_func) (json5_value * value, void * arg);
+
+/**
+ * Defines limits for untrusted input. A limit of 0 disables the check.
+ */
+typedef struct {
+	size_t max_depth;      ///< Maximum container nesting depth.
+	size_t max_values;     ///< Maximum number of values.
+	size_t max_string_len; ///< Maximum string and key length in bytes.
+	size_t max_bytes;      ///< Maximum approximate size of the decoded values in bytes.
+} json5_limits;
+
+/**
+ * Defines how repeated object keys are handled.
+ */
+typedef enum {
+	JSON5_DUP_LAST = 0, ///< Use the last value.
+	JSON5_DUP_FIRST,    ///< Use the first value. Later values are only validated.
+	JSON5_DUP_REJECT,   ///< Report an error.
+} json5_dup_policy;
+
 typedef struct {
 	int state;
 	json5_value * value;
+	size_t old_len;   ///< Container length before it was reused.
+	size_t keys_base; ///< Start of object keys in the key stack.
+	size_t object;    ///< Object number identifying its keys in the seen key set.
 } json5_parser_item;
 
+/**
+ * Defines a key seen in a reused object.
+ */
+typedef struct {
+	uint8_t const * key; ///< The interned key.
+	size_t object;       ///< The number of the object containing the key.
+} json5_parser_seen;
+
 typedef struct {
 	json5_parser_item * stack;
 	size_t stack_len;
 	size_t stack_cap;
 	json5_parser_funcs const * funcs;
 	void * funcs_arg;
+	json5_parser_value_func item_func;
+	void * item_arg;
+	size_t item_depth;
+	size_t depth;
+	json5_limits limits;
+	size_t values;
+	size_t bytes;
+	json5_dup_policy dup_policy;
+	json5_keyset const * keyset; ///< Key set used for decoded objects.
+	uint8_t const ** keys;
+	size_t keys_len;
+	size_t keys_cap;
+	json5_parser_seen * seen;
+	size_t seen_len;
+	size_t seen_cap;
+	size_t objects; ///< Number of objects opened in the current document.
+	json5_key_table interned; ///< Object keys shared in the current document.
 	json5_value value;
 	json5_value error;
 } json5_parser;
@@ -107,11 +162,91 @@ extern void json5_parser_reset (json5_parser * parser);
  */
 extern void json5_parser_destroy (json5_parser * parser);
 
+/**
+ * Shrink the stack to its initial size and release the key buffers and the
+ * interned key table if they are larger than @p max_size bytes.
+ *
+ * Resets the parser if any memory is released. Returns 1 if any memory was
+ * released or 0 otherwise.
+ */
+extern int json5_parser_trim (json5_parser * parser, size_t max_size);
+
+/**
+ * Set a callback function receiving the items of arrays at the given nesting
+ * depth one by one instead of appending them to the array.
+ *
+ * A @p depth of 0 selects the root array. The items are removed from the
+ * array after @p func returns, so only one item is held in memory at a time.
+ * Pass `NULL` as @p func to build complete arrays again. Only used if no
+ * parser callback functions are set.
+ */
+extern void json5_parser_set_item_func (json5_parser * parser, size_t depth, json5_parser_value_func func, void * arg);
+
+/**
+ * Set limits checked for every parsed value and key
+ *
+ * Exceeding a limit is reported as error. Pass `NULL` to remove all limits.
+ * The limits are kept when the parser is reset.
+ */
+extern void json5_parser_set_limits (json5_parser * parser, json5_limits const * limits);
+
+/**
+ * Set how repeated object keys are handled
+ *
+ * The default is `JSON5_DUP_LAST`. Only used if no parser callback functions
+ * are set. The policy is kept when the parser is reset.
+ */
+extern void json5_parser_set_dup_policy (json5_parser * parser, json5_dup_policy policy);
+
+/**
+ * Set a key set used for decoded objects
+ *
+ * Objects whose keys all belong to @p keyset store their values in an array
+ * indexed by key ID. See `json5_value_use_keyset`. Pass `NULL` to store all
+ * objects as property tables. Only used if no parser callback functions are
+ * set. The key set is kept when the parser is reset.
+ */
+extern void json5_parser_set_keyset (json5_parser * parser, json5_keyset const * keyset);
+
 /**
  * Parser tokens
  */
 extern int json5_parser_put_tokens (json5_parser * parser, json5_token const * tokens, size_t count);
 
+/**
+ * Tokenize and parse a complete JSON string
+ *
+ * Pulls the tokens directly from @p tknzr and builds the value tree without
+ * going through a token callback. Parser callback functions are ignored.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_parser_decode (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const * chars, size_t size);
+
+/**
+ * Tokenize and parse characters until at most @p max_tokens tokens have been
+ * parsed
+ *
+ * Works like `json5_parser_decode` but can be resumed. @p chars is advanced
+ * past the consumed characters. If @p final is not 0, the characters up to
+ * @p end are the last ones.
+ *
+ * Returns the number of parsed tokens or -1 if an error occurred.
+ */
+extern ssize_t json5_parser_decode_tokens (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const ** chars, uint8_t const * end, int final, size_t max_tokens);
+
+/**
+ * Tokenize and parse a complete JSON string into an existing value
+ *
+ * Works like `json5_parser_decode` but reuses the containers, strings and
+ * object keys of @p value where the decoded document has the same shape.
+ * Properties and items not present in the document are removed. On error,
+ * @p value contains a partially updated but valid value tree.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_parser_decode_into (json5_parser * parser, json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_value * value);
+
 /**
  * Check if parser is finished
  *
@@ -119,6 +254,14 @@ extern int json5_parser_put_tokens (json5_parser * parser, json5_token const * t
  */
 extern int json5_parser_is_finished (json5_parser const * parser);
 
+/**
+ * Check if the root value has been parsed completely
+ *
+ * Returns 1 if the root value is complete but the end of input has not been
+ * seen yet
+ */
+extern int json5_parser_root_complete (json5_parser const * parser);
+
 /**
  * Check if parser has encountered an error
  */
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "json5-pipeline.h"
+
+/**
+ * Number of batches in the ring. Has to be a power of 2.
+ */
+#define RING_SIZE 16
+
+/**
+ * Number of tokens per batch
+ */
+#define BATCH_SIZE 512
+
+/**
+ * Initial size of the token string buffer of a batch
+ */
+#define INIT_CHARS_CAP (16 * 1024)
+
+/**
+ * Number of spins before yielding while waiting for the other thread
+ */
+#define SPIN_COUNT 64
+
+/**
+ * A batch of tokens owning the token strings
+ */
+typedef struct {
+	json5_token tokens [BATCH_SIZE];
+	size_t len;
+	uint8_t * chars;
+	size_t chars_len;
+	size_t chars_cap;
+} json5_pipeline_batch;
+
+/**
+ * The ring shared by the tokenizer and parser thread
+ */
+typedef struct {
+	json5_pipeline_batch batches [RING_SIZE];
+	atomic_size_t head; ///< Number of published batches. Written by tokenizer.
+	char pad1 [64];
+	atomic_size_t tail; ///< Number of parsed batches. Written by parser.
+	char pad2 [64];
+	atomic_int done;    ///< 1 if tokenizer finished, -1 if an error occurred.
+	atomic_int abort;   ///< Set by parser to stop tokenizer.
+	json5_tokenizer * tknzr;
+	uint8_t const * chars;
+	uint8_t const * end;
+} json5_pipeline;
+
+static void json5_pipeline_wait (unsigned * spins) {
+	if (++ *spins >= SPIN_COUNT) {
+		*spins = 0;
+		sched_yield ();
+	}
+}
+
+/**
+ * Get next free batch or NULL if the parser aborted
+ */
+static json5_pipeline_batch * json5_pipeline_acquire (json5_pipeline * pipeline) {
+	json5_pipeline_batch * batch;
+	unsigned spins = 0;
+	size_t head = atomic_load_explicit (&pipeline -> head, memory_order_relaxed);
+
+	while (head - atomic_load_explicit (&pipeline -> tail, memory_order_acquire) >= RING_SIZE) {
+		if (atomic_load_explicit (&pipeline -> abort, memory_order_relaxed)) {
+			return NULL;
+		}
+
+		json5_pipeline_wait (&spins);
+	}
+
+	batch = &pipeline -> batches [head & (RING_SIZE - 1)];
+	batch -> len = 0;
+	batch -> chars_len = 0;
+
+	return batch;
+}
+
+static void json5_pipeline_publish (json5_pipeline * pipeline) {
+	size_t head = atomic_load_explicit (&pipeline -> head, memory_order_relaxed);
+
+	atomic_store_explicit (&pipeline -> head, head + 1, memory_order_release);
+}
+
+static int json5_pipeline_reserve (json5_pipeline_batch * batch, size_t size) {
+	uint8_t * chars;
+	size_t new_cap = batch -> chars_cap;
+
+	while (size > new_cap) {
+		new_cap *= 2;
+	}
+
+	if (!(chars = realloc (batch -> chars, new_cap))) {
+		return -1;
+	}
+
+	batch -> chars = chars;
+	batch -> chars_cap = new_cap;
+
+	return 0;
+}
+
+/**
+ * Tokenizer thread
+ */
+static void * json5_pipeline_tokenize (void * arg) {
+	int res = 0;
+	json5_pipeline * pipeline = arg;
+	json5_pipeline_batch * batch = NULL;
+	json5_token const * token;
+	json5_token * item;
+	size_t size;
+
+	for (;;) {
+		if ((res = json5_tokenizer_next_token (pipeline -> tknzr, &pipeline -> chars, pipeline -> end, 1, &token)) <= 0) {
+			break;
+		}
+
+		size = token -> length + 1;
+
+		// publish batch if full or token string does not fit
+		if (batch && (batch -> len >= BATCH_SIZE || batch -> chars_len + size > batch -> chars_cap)) {
+			json5_pipeline_publish (pipeline);
+			batch = NULL;
+
+			// stop scanning if the parser failed
+			if (atomic_load_explicit (&pipeline -> abort, memory_order_relaxed)) {
+				break;
+			}
+		}
+
+		if (!batch && !(batch = json5_pipeline_acquire (pipeline))) {
+			break;
+		}
+
+		if (size > batch -> chars_cap && json5_pipeline_reserve (batch, size) != 0) {
+			res = -1;
+			break;
+		}
+
+		item = &batch -> tokens [batch -> len ++];
+		*item = *token;
+		item -> token = &batch -> chars [batch -> chars_len];
+
+		if (token -> length) {
+			memcpy (item -> token, token -> token, token -> length);
+		}
+
+		item -> token [token -> length] = '\0';
+		batch -> chars_len += size;
+	}
+
+	if (batch) {
+		json5_pipeline_publish (pipeline);
+	}
+
+	atomic_store_explicit (&pipeline -> done, res < 0 ? -1 : 1, memory_order_release);
+
+	return NULL;
+}
+
+/**
+ * Parse batches until the tokenizer is finished
+ */
+static int json5_pipeline_parse (json5_pipeline * pipeline, json5_parser * parser) {
+	int done;
+	unsigned spins = 0;
+	size_t head;
+	size_t tail = 0;
+	json5_pipeline_batch * batch;
+
+	for (;;) {
+		done = atomic_load_explicit (&pipeline -> done, memory_order_acquire);
+		head = atomic_load_explicit (&pipeline -> head, memory_order_acquire);
+
+		if (tail == head) {
+			if (done) {
+				return done < 0 ? -1 : 0;
+			}
+
+			json5_pipeline_wait (&spins);
+			continue;
+		}
+
+		spins = 0;
+
+		while (tail != head) {
+			batch = &pipeline -> batches [tail & (RING_SIZE - 1)];
+
+			if (json5_parser_put_tokens (parser, batch -> tokens, batch -> len) != 0) {
+				atomic_store_explicit (&pipeline -> abort, 1, memory_order_relaxed);
+
+				return -1;
+			}
+
+			atomic_store_explicit (&pipeline -> tail, ++ tail, memory_order_release);
+		}
+	}
+}
+
+int json5_pipeline_decode (json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_value) {
+	int res = -1;
+	pthread_t thread;
+	json5_pipeline * pipeline;
+
+	// no second core to run the tokenizer on
+	if (size < JSON5_PIPELINE_MIN_SIZE || sysconf (_SC_NPROCESSORS_ONLN) < 2) {
+		return json5_coder_decode (coder, string, size, out_value);
+	}
+
+	if (!(pipeline = calloc (1, sizeof (*pipeline)))) {
+		return -1;
+	}
+
+	for (size_t i = 0; i < RING_SIZE; i ++) {
+		json5_pipeline_batch * batch = &pipeline -> batches [i];
+
+		if (!(batch -> chars = malloc (INIT_CHARS_CAP))) {
+			goto cleanup;
+		}
+
+		batch -> chars_cap = INIT_CHARS_CAP;
+	}
+
+	json5_coder_reset (coder);
+
+	atomic_init (&pipeline -> head, 0);
+	atomic_init (&pipeline -> tail, 0);
+	atomic_init (&pipeline -> done, 0);
+	atomic_init (&pipeline -> abort, 0);
+	pipeline -> tknzr = &coder -> tknzr;
+	pipeline -> chars = string;
+	pipeline -> end = &string [size];
+
+	if (pthread_create (&thread, NULL, json5_pipeline_tokenize, pipeline) != 0) {
+		goto cleanup;
+	}
+
+	res = json5_pipeline_parse (pipeline, &coder -> parser);
+
+	pthread_join (thread, NULL);
+
+	if (res == 0) {
+		json5_value_set_null (out_value);
+		*out_value = coder -> parser.value;
+		memset (&coder -> parser.value, 0, sizeof (coder -> parser.value));
+	}
+
+	cleanup: {
+		for (size_t i = 0; i < RING_SIZE; i ++) {
+			free (pipeline -> batches [i].chars);
+		}
+
+		free (pipeline);
+
+		return res;
+	}
+}
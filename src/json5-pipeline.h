@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+
+/**
+ * Minimum input size in bytes for which a tokenizer thread is started.
+ *
+ * Smaller strings are decoded with `json5_coder_decode`.
+ */
+#define JSON5_PIPELINE_MIN_SIZE (256 * 1024)
+
+/**
+ * Decode a JSON string with two threads
+ *
+ * A separate thread tokenizes the string and passes the tokens to the
+ * calling thread in batches through a lock-free single-producer
+ * single-consumer ring. The calling thread parses the tokens and builds the
+ * value tree. The token strings are copied into a buffer owned by the batch
+ * and stay valid until the batch is parsed.
+ *
+ * Strings smaller than `JSON5_PIPELINE_MIN_SIZE` or decoded on machines with
+ * a single processor are decoded on the calling thread only.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_pipeline_decode (json5_coder * coder, uint8_t const * string, size_t size, json5_value * out_value);
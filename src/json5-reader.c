@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json5-reader.h"
+
+#define INIT_STACK_CAP 32
+
+/**
+ * Defines reader states
+ */
+typedef enum {
+	JSON5_STATE_VALUE = 0,
+	JSON5_STATE_ARR_VAL,
+	JSON5_STATE_ARR_SEP,
+	JSON5_STATE_OBJ_KEY,
+	JSON5_STATE_OBJ_KEY_SEP,
+	JSON5_STATE_OBJ_SEP,
+	JSON5_STATE_ROOT, // parsed root element
+	JSON5_STATE_END,
+	JSON5_STATE_ERROR,
+} json5_reader_state;
+
+static void json5_reader_set_error (json5_reader * reader, char const * error)
+{
+	json5_value_set_string (&reader -> error, error, -1);
+
+	reader -> state = JSON5_STATE_ERROR;
+}
+
+static void json5_reader_token_error (json5_reader * reader, json5_token const * token)
+{
+	char error [128];
+
+	json5_token_format_error (token, error, sizeof (error));
+	json5_reader_set_error (reader, error);
+}
+
+int json5_reader_init (json5_reader * reader) {
+	memset (reader, 0, sizeof (*reader));
+
+	if (json5_tokenizer_init (&reader -> tknzr) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+void json5_reader_reset (json5_reader * reader) {
+	json5_tokenizer_reset (&reader -> tknzr);
+	json5_value_set_null (&reader -> error);
+
+	reader -> state = JSON5_STATE_VALUE;
+	reader -> stack_len = 0;
+	reader -> chars = NULL;
+	reader -> end = NULL;
+	reader -> final = 0;
+}
+
+void json5_reader_destroy (json5_reader * reader) {
+	json5_tokenizer_destroy (&reader -> tknzr);
+	json5_value_set_null (&reader -> error);
+	free (reader -> stack);
+
+	memset (reader, 0, sizeof (*reader));
+}
+
+void json5_reader_put_chars (json5_reader * reader, uint8_t const * chars, size_t size) {
+	if (!chars && !size) {
+		reader -> final = 1;
+	}
+	else {
+		reader -> chars = chars;
+		reader -> end = &chars [size];
+	}
+}
+
+static int json5_reader_push (json5_reader * reader, json5_reader_state state) {
+	if (reader -> stack_len >= reader -> stack_cap) {
+		size_t new_cap = reader -> stack_cap ? reader -> stack_cap * 2 : INIT_STACK_CAP;
+		uint8_t * stack = realloc (reader -> stack, new_cap);
+
+		if (!stack) {
+			return -1;
+		}
+
+		reader -> stack = stack;
+		reader -> stack_cap = new_cap;
+	}
+
+	reader -> stack [reader -> stack_len ++] = state;
+
+	return 0;
+}
+
+/**
+ * Set state after a complete value
+ */
+static void json5_reader_end_value (json5_reader * reader) {
+	if (reader -> stack_len) {
+		reader -> state = reader -> stack [reader -> stack_len - 1];
+	}
+	else {
+		reader -> state = JSON5_STATE_ROOT;
+	}
+}
+
+int json5_reader_next (json5_reader * reader, json5_event * event) {
+	int res;
+	json5_token const * token;
+
+	for (;;) {
+		if (reader -> state >= JSON5_STATE_END) {
+			return reader -> state == JSON5_STATE_ERROR ? -1 : 0;
+		}
+
+		res = json5_tokenizer_next_token (&reader -> tknzr, &reader -> chars, reader -> end, reader -> final, &token);
+
+		if (res <= 0) {
+			if (res < 0) {
+				json5_reader_set_error (reader, json5_tokenizer_get_error (&reader -> tknzr));
+			}
+
+			return res;
+		}
+
+		event -> token = token;
+		event -> depth = reader -> stack_len;
+
+		switch (reader -> state) {
+			case JSON5_STATE_VALUE: {
+				goto value;
+				break;
+			}
+			case JSON5_STATE_ARR_VAL: {
+				if (token -> type == JSON5_TOK_ARR_CLOSE) {
+					goto end_container;
+				}
+
+				goto value;
+				break;
+			}
+			case JSON5_STATE_ARR_SEP: {
+				switch (token -> type) {
+					case JSON5_TOK_COMMA: {
+						reader -> state = JSON5_STATE_ARR_VAL;
+						continue;
+						break;
+					}
+					case JSON5_TOK_ARR_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+				break;
+			}
+			case JSON5_STATE_OBJ_KEY: {
+				switch (token -> type) {
+					case JSON5_TOK_NAME:
+					case JSON5_TOK_STRING:
+					case JSON5_TOK_NUMBER_BOOL:
+					case JSON5_TOK_NULL:
+					case JSON5_TOK_NAN:
+					case JSON5_TOK_INFINITY: {
+						reader -> state = JSON5_STATE_OBJ_KEY_SEP;
+						event -> type = JSON5_EVENT_KEY;
+
+						return 1;
+						break;
+					}
+					case JSON5_TOK_OBJ_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+				break;
+			}
+			case JSON5_STATE_OBJ_KEY_SEP: {
+				switch (token -> type) {
+					case JSON5_TOK_COLON: {
+						reader -> state = JSON5_STATE_VALUE;
+						continue;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+				break;
+			}
+			case JSON5_STATE_OBJ_SEP: {
+				switch (token -> type) {
+					case JSON5_TOK_COMMA: {
+						reader -> state = JSON5_STATE_OBJ_KEY;
+						continue;
+						break;
+					}
+					case JSON5_TOK_OBJ_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+				break;
+			}
+			case JSON5_STATE_ROOT: {
+				switch (token -> type) {
+					case JSON5_TOK_END: {
+						reader -> state = JSON5_STATE_END;
+						event -> type = JSON5_EVENT_END;
+
+						return 1;
+						break;
+					}
+					default: {
+						char error [128];
+
+						snprintf (error, sizeof (error), "Extra token in root context on line %d:%d",
+							token -> offset.lineno + 1, token -> offset.colno);
+						json5_reader_set_error (reader, error);
+
+						return -1;
+						break;
+					}
+				}
+				break;
+			}
+			default: {
+				break;
+			}
+		}
+	}
+
+	value: {
+		switch (token -> type) {
+			case JSON5_TOK_OBJ_OPEN: {
+				if (json5_reader_push (reader, JSON5_STATE_OBJ_SEP) != 0) {
+					goto alloc_error;
+				}
+
+				reader -> state = JSON5_STATE_OBJ_KEY;
+				event -> type = JSON5_EVENT_BEGIN_OBJ;
+				break;
+			}
+			case JSON5_TOK_ARR_OPEN: {
+				if (json5_reader_push (reader, JSON5_STATE_ARR_SEP) != 0) {
+					goto alloc_error;
+				}
+
+				reader -> state = JSON5_STATE_ARR_VAL;
+				event -> type = JSON5_EVENT_BEGIN_ARR;
+				break;
+			}
+			case JSON5_TOK_STRING:
+			case JSON5_TOK_NUMBER:
+			case JSON5_TOK_NUMBER_FLOAT:
+			case JSON5_TOK_NUMBER_BOOL:
+			case JSON5_TOK_NULL:
+			case JSON5_TOK_NAN:
+			case JSON5_TOK_INFINITY: {
+				json5_reader_end_value (reader);
+				event -> type = JSON5_EVENT_VALUE;
+				break;
+			}
+			default: {
+				goto unexpected_token;
+				break;
+			}
+		}
+
+		return 1;
+	}
+
+	end_container: {
+		reader -> stack_len --;
+		json5_reader_end_value (reader);
+		event -> type = token -> type == JSON5_TOK_OBJ_CLOSE ? JSON5_EVENT_END_OBJ : JSON5_EVENT_END_ARR;
+		event -> depth = reader -> stack_len;
+
+		return 1;
+	}
+
+	unexpected_token: {
+		json5_reader_token_error (reader, token);
+
+		return -1;
+	}
+
+	alloc_error: {
+		json5_reader_set_error (reader, "Allocation error");
+
+		return -1;
+	}
+}
+
+int json5_reader_skip (json5_reader * reader, json5_event const * event) {
+	int res;
+	json5_event next;
+
+	if (event -> type != JSON5_EVENT_BEGIN_OBJ && event -> type != JSON5_EVENT_BEGIN_ARR) {
+		return 1;
+	}
+
+	while (reader -> stack_len > event -> depth) {
+		if ((res = json5_reader_next (reader, &next)) <= 0) {
+			return res;
+		}
+	}
+
+	return 1;
+}
+
+char const * json5_reader_get_error (json5_reader const * reader) {
+	if (reader -> state != JSON5_STATE_ERROR) {
+		return NULL;
+	}
+
+	return (char const *) json5_value_get_string (&reader -> error);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-tokenizer.h"
+#include "json5-value.h"
+
+/**
+ * Defines reader event types.
+ */
+typedef enum {
+	JSON5_EVENT_NONE = 0,
+	JSON5_EVENT_BEGIN_OBJ, ///< {
+	JSON5_EVENT_END_OBJ,   ///< }
+	JSON5_EVENT_BEGIN_ARR, ///< [
+	JSON5_EVENT_END_ARR,   ///< ]
+	JSON5_EVENT_KEY,       ///< Object key. Followed by its value.
+	JSON5_EVENT_VALUE,     ///< Scalar value.
+	JSON5_EVENT_END,       ///< End of input after the root value.
+} json5_event_type;
+
+/**
+ * Defines a reader event.
+ */
+typedef struct {
+	json5_event_type type;      ///< The event type.
+	json5_token const * token;  ///< The token. Only valid until the next call.
+	size_t depth;               ///< The container nesting depth.
+} json5_event;
+
+/**
+ * The pull reader object.
+ *
+ * Returns the tokens of a JSON string as validated events one at a time.
+ */
+typedef struct {
+	json5_tokenizer tknzr;
+	int state;
+	uint8_t * stack;
+	size_t stack_len;
+	size_t stack_cap;
+	uint8_t const * chars;
+	uint8_t const * end;
+	int final;
+	json5_value error;
+} json5_reader;
+
+/**
+ * Initialize a reader.
+ *
+ * Returns 0 on success or -1 if an error occurred.
+ */
+extern int json5_reader_init (json5_reader * reader);
+
+/**
+ * Reset a reader.
+ *
+ * It then can be used to read a new JSON string. The allocated memory will
+ * be preserved.
+ */
+extern void json5_reader_reset (json5_reader * reader);
+
+/**
+ * Destroy a reader.
+ */
+extern void json5_reader_destroy (json5_reader * reader);
+
+/**
+ * Set the next characters to read.
+ *
+ * Has to be called again with new characters when `json5_reader_next` returns
+ * 0 and no `JSON5_EVENT_END` event was returned yet. Pass `NULL` and 0 to mark
+ * the end of input. Characters not yet read are kept in that case, so an
+ * in-memory string can be read by calling this function twice before reading
+ * any events.
+ *
+ * The characters have to be valid until they are consumed.
+ */
+extern void json5_reader_put_chars (json5_reader * reader, uint8_t const * chars, size_t size);
+
+/**
+ * Read the next event.
+ *
+ * Returns 1 if an event was written to @p event, 0 if more characters are
+ * needed or the end of input was reached, or -1 if an error occurred.
+ */
+extern int json5_reader_next (json5_reader * reader, json5_event * event);
+
+/**
+ * Skip the container started by @p event.
+ *
+ * If @p event is a `JSON5_EVENT_BEGIN_OBJ` or `JSON5_EVENT_BEGIN_ARR` event,
+ * all events up to the matching end event are read. Otherwise, nothing is
+ * done.
+ *
+ * Returns 1 if the container was skipped, 0 if more characters are needed
+ * and the function has to be called again with the same event, or -1 if an
+ * error occurred.
+ */
+extern int json5_reader_skip (json5_reader * reader, json5_event const * event);
+
+/**
+ * Returns the last error message or NULL if no error is present.
+ */
+extern char const * json5_reader_get_error (json5_reader const * reader);
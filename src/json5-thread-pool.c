@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "json5-thread-pool.h"
+
+#define RANGE_PACK(begin, end) (((uint64_t) (begin) << 32) | (uint32_t) (end))
+#define RANGE_BEGIN(range) ((size_t) ((range) >> 32))
+#define RANGE_END(range) ((size_t) ((range) & 0xFFFFFFFF))
+
+/**
+ * Defines a pool worker thread
+ */
+typedef struct {
+	pthread_t thread;
+	json5_coder coder; // only used by this worker
+	_Atomic uint64_t range; // queued input indexes
+	json5_thread_pool * pool;
+} json5_thread_pool_worker;
+
+struct json5_thread_pool {
+	json5_thread_pool_worker * workers;
+	size_t count;
+	pthread_mutex_t lock;
+	pthread_mutex_t batch_lock; // serializes batches
+	pthread_cond_t start_cond;
+	pthread_cond_t done_cond;
+	unsigned long generation;
+	size_t active; // workers not finished with current batch
+	int stop;
+	struct {
+		uint8_t const * const * inputs;
+		size_t const * lens;
+		json5_value * outs;
+		int * results;
+		atomic_size_t failed;
+	} batch;
+};
+
+/**
+ * Take the next input from the worker's own range
+ *
+ * Returns 1 if an input index was written to @p out_index or 0 if the range
+ * is empty.
+ */
+static int json5_thread_pool_take (json5_thread_pool_worker * worker, size_t * out_index) {
+	uint64_t range = atomic_load (&worker -> range);
+	size_t begin;
+	size_t end;
+
+	do {
+		begin = RANGE_BEGIN (range);
+		end = RANGE_END (range);
+
+		if (begin >= end) {
+			return 0;
+		}
+	}
+	while (!atomic_compare_exchange_weak (&worker -> range, &range, RANGE_PACK (begin + 1, end)));
+
+	*out_index = begin;
+
+	return 1;
+}
+
+/**
+ * Steal the upper half of the largest range of another worker
+ *
+ * Returns 1 if an input index was written to @p out_index and the rest of
+ * the stolen inputs were added to the worker's own range, or 0 if no work is
+ * left.
+ */
+static int json5_thread_pool_steal (json5_thread_pool_worker * worker, size_t * out_index) {
+	json5_thread_pool * pool = worker -> pool;
+	json5_thread_pool_worker * victim;
+	uint64_t range;
+	size_t begin;
+	size_t end;
+	size_t mid;
+	size_t size;
+	size_t max_size;
+
+	for (;;) {
+		victim = NULL;
+		max_size = 0;
+
+		for (size_t i = 0; i < pool -> count; i ++) {
+			range = atomic_load (&pool -> workers [i].range);
+			begin = RANGE_BEGIN (range);
+			end = RANGE_END (range);
+			size = end > begin ? end - begin : 0;
+
+			if (size > max_size) {
+				max_size = size;
+				victim = &pool -> workers [i];
+			}
+		}
+
+		if (!victim) {
+			return 0;
+		}
+
+		range = atomic_load (&victim -> range);
+		begin = RANGE_BEGIN (range);
+		end = RANGE_END (range);
+
+		if (begin >= end) {
+			continue;
+		}
+
+		mid = begin + (end - begin) / 2;
+
+		if (atomic_compare_exchange_weak (&victim -> range, &range, RANGE_PACK (begin, mid))) {
+			// own range is empty and cannot be stolen from
+			atomic_store (&worker -> range, RANGE_PACK (mid + 1, end));
+			*out_index = mid;
+
+			return 1;
+		}
+	}
+}
+
+static void json5_thread_pool_run_batch (json5_thread_pool_worker * worker) {
+	int res;
+	size_t index;
+	json5_thread_pool * pool = worker -> pool;
+
+	while (json5_thread_pool_take (worker, &index) || json5_thread_pool_steal (worker, &index)) {
+		res = json5_coder_decode (&worker -> coder, pool -> batch.inputs [index], pool -> batch.lens [index], &pool -> batch.outs [index]);
+
+		if (pool -> batch.results) {
+			pool -> batch.results [index] = res != 0 ? -1 : 0;
+		}
+
+		if (res != 0) {
+			atomic_fetch_add (&pool -> batch.failed, 1);
+		}
+	}
+}
+
+static void * json5_thread_pool_work (void * arg) {
+	json5_thread_pool_worker * worker = arg;
+	json5_thread_pool * pool = worker -> pool;
+	unsigned long generation = 0;
+
+	for (;;) {
+		pthread_mutex_lock (&pool -> lock);
+
+		while (!pool -> stop && pool -> generation == generation) {
+			pthread_cond_wait (&pool -> start_cond, &pool -> lock);
+		}
+
+		if (pool -> stop) {
+			pthread_mutex_unlock (&pool -> lock);
+			break;
+		}
+
+		generation = pool -> generation;
+		pthread_mutex_unlock (&pool -> lock);
+
+		json5_thread_pool_run_batch (worker);
+
+		pthread_mutex_lock (&pool -> lock);
+
+		if (-- pool -> active == 0) {
+			pthread_cond_signal (&pool -> done_cond);
+		}
+
+		pthread_mutex_unlock (&pool -> lock);
+	}
+
+	return NULL;
+}
+
+json5_thread_pool * json5_thread_pool_create (size_t threads) {
+	long count;
+	json5_thread_pool * pool;
+	json5_thread_pool_worker * worker;
+
+	if (!threads) {
+		count = sysconf (_SC_NPROCESSORS_ONLN);
+		threads = count > 0 ? count : 1;
+	}
+
+	if (!(pool = calloc (1, sizeof (*pool)))) {
+		return NULL;
+	}
+
+	if (!(pool -> workers = calloc (threads, sizeof (*pool -> workers)))) {
+		free (pool);
+		return NULL;
+	}
+
+	pthread_mutex_init (&pool -> lock, NULL);
+	pthread_mutex_init (&pool -> batch_lock, NULL);
+	pthread_cond_init (&pool -> start_cond, NULL);
+	pthread_cond_init (&pool -> done_cond, NULL);
+	atomic_init (&pool -> batch.failed, 0);
+
+	for (size_t i = 0; i < threads; i ++) {
+		worker = &pool -> workers [i];
+		worker -> pool = pool;
+		atomic_init (&worker -> range, 0);
+
+		if (json5_coder_init (&worker -> coder) != 0) {
+			goto cleanup;
+		}
+
+		if (pthread_create (&worker -> thread, NULL, json5_thread_pool_work, worker) != 0) {
+			json5_coder_destroy (&worker -> coder);
+			goto cleanup;
+		}
+
+		pool -> count ++;
+	}
+
+	return pool;
+
+	cleanup: {
+		json5_thread_pool_destroy (pool);
+
+		return NULL;
+	}
+}
+
+void json5_thread_pool_destroy (json5_thread_pool * pool) {
+	pthread_mutex_lock (&pool -> lock);
+	pool -> stop = 1;
+	pthread_cond_broadcast (&pool -> start_cond);
+	pthread_mutex_unlock (&pool -> lock);
+
+	for (size_t i = 0; i < pool -> count; i ++) {
+		pthread_join (pool -> workers [i].thread, NULL);
+		json5_coder_destroy (&pool -> workers [i].coder);
+	}
+
+	pthread_mutex_destroy (&pool -> lock);
+	pthread_mutex_destroy (&pool -> batch_lock);
+	pthread_cond_destroy (&pool -> start_cond);
+	pthread_cond_destroy (&pool -> done_cond);
+	free (pool -> workers);
+	free (pool);
+}
+
+size_t json5_decode_batch (uint8_t const * const inputs [], size_t const lens [], size_t n, json5_value outs [], json5_thread_pool * pool, int results []) {
+	size_t failed;
+	size_t begin = 0;
+	size_t end;
+
+	if (!n) {
+		return 0;
+	}
+
+	pthread_mutex_lock (&pool -> batch_lock);
+
+	// distribute inputs evenly
+	for (size_t i = 0; i < pool -> count; i ++) {
+		end = n * (i + 1) / pool -> count;
+		atomic_store (&pool -> workers [i].range, RANGE_PACK (begin, end));
+		begin = end;
+	}
+
+	pool -> batch.inputs = inputs;
+	pool -> batch.lens = lens;
+	pool -> batch.outs = outs;
+	pool -> batch.results = results;
+	atomic_store (&pool -> batch.failed, 0);
+
+	pthread_mutex_lock (&pool -> lock);
+	pool -> active = pool -> count;
+	pool -> generation ++;
+	pthread_cond_broadcast (&pool -> start_cond);
+
+	while (pool -> active) {
+		pthread_cond_wait (&pool -> done_cond, &pool -> lock);
+	}
+
+	pthread_mutex_unlock (&pool -> lock);
+
+	failed = atomic_load (&pool -> batch.failed);
+	pthread_mutex_unlock (&pool -> batch_lock);
+
+	return failed;
+}
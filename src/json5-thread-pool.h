@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "json5-coder.h"
+
+/**
+ * A fixed set of worker threads decoding batches of strings.
+ */
+typedef struct json5_thread_pool json5_thread_pool;
+
+/**
+ * Create a thread pool.
+ *
+ * @param threads The number of worker threads. If 0, the number of online
+ * processors is used.
+ *
+ * @return The pool or NULL if an error occurred.
+ */
+extern json5_thread_pool * json5_thread_pool_create (size_t threads);
+
+/**
+ * Destroy a thread pool.
+ *
+ * Waits for all workers to exit and frees the pool.
+ *
+ * @param pool The pool to destroy.
+ */
+extern void json5_thread_pool_destroy (json5_thread_pool * pool);
+
+/**
+ * Decode multiple independent JSON strings.
+ *
+ * The inputs are distributed evenly over the workers. Workers finished with
+ * their own inputs steal half of the remaining inputs of the busiest worker,
+ * so a few large inputs do not stall the batch. Each worker decodes with its
+ * own coder, which is reused for all batches.
+ *
+ * Blocks until all inputs are decoded. Batches passed from multiple threads
+ * are decoded one after another.
+ *
+ * @param inputs The strings to decode.
+ * @param lens The string sizes in bytes.
+ * @param n The number of strings. Has to be less than 2^32.
+ * @param outs The decoded values. Values of strings with errors are not
+ * changed.
+ * @param pool The pool.
+ * @param results Receives 0 or -1 for each string if an error occurred. Can
+ * be `NULL`.
+ *
+ * @return The number of strings with errors.
+ */
+extern size_t json5_decode_batch (uint8_t const * const inputs [], size_t const lens [], size_t n, json5_value outs [], json5_thread_pool * pool, int results []);
@@ -282,10 +282,16 @@ int json5_tokenizer_init (json5_tokenizer * tknzr) {
 void json5_tokenizer_reset (json5_tokenizer * tknzr) {
 	uint8_t * buffer = tknzr -> buffer;
 	size_t buffer_cap = tknzr -> buffer_cap;
+	size_t max_length = tknzr -> max_length;
 
 	memset (tknzr, 0, sizeof (*tknzr));
 	tknzr -> buffer = buffer;
 	tknzr -> buffer_cap = buffer_cap;
+	tknzr -> max_length = max_length;
+}
+
+void json5_tokenizer_set_max_length (json5_tokenizer * tknzr, size_t max_length) {
+	tknzr -> max_length = max_length;
 }
 
 void json5_tokenizer_destroy (json5_tokenizer * tknzr) {
@@ -296,6 +302,25 @@ void json5_tokenizer_destroy (json5_tokenizer * tknzr) {
 	memset (tknzr, 0, sizeof (*tknzr));
 }
 
+int json5_tokenizer_trim (json5_tokenizer * tknzr, size_t max_size) {
+	uint8_t * buffer;
+
+	if (tknzr -> buffer_cap <= max_size || tknzr -> buffer_cap <= INIT_BUF_CAP) {
+		return 0;
+	}
+
+	json5_tokenizer_reset (tknzr);
+
+	if (!(buffer = realloc (tknzr -> buffer, INIT_BUF_CAP))) {
+		return 0;
+	}
+
+	tknzr -> buffer = buffer;
+	tknzr -> buffer_cap = INIT_BUF_CAP;
+
+	return 1;
+}
+
 static void json5_tokenizer_conv_number_float (json5_tokenizer * tknzr) {
 	if (tknzr -> number.type != JSON5_NUM_FLOAT) {
 		tknzr -> number.mant.f = tknzr -> number.mant.i;
@@ -421,34 +446,57 @@ static void json5_tokenizer_number_end (json5_tokenizer * tknzr) {
 	}
 }
 
-static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_put_token_func put_token, void * arg) {
+/**
+ * Scan chars until a token is accepted
+ *
+ * Returns 1 if a token was accepted, 0 if more chars are needed and -1 if an
+ * error occurred. If the char terminating a token has to be reprocessed, it
+ * is saved in `pending` and handled first on the next call.
+ */
+static int json5_tokenizer_scan (json5_tokenizer * tknzr, uint8_t const ** chars_ref, uint8_t const * end, int final, json5_token const ** out_token) {
 	int c = 0;
 	int state = 0;
 	int value = 0;
+	int again;
+	int accept;
 	json5_off offset;
 	json5_tok_type char_type = 0;
 	json5_token * token;
 	json5_ut_info const * info = NULL;
-	uint8_t const * end = &chars [size];
+	uint8_t const * chars = *chars_ref;
 
 	if (tknzr -> state >= JSON5_STATE_END) {
-		return 0;
+		return tknzr -> state == JSON5_STATE_ERROR ? -1 : 0;
 	}
 
 	state = tknzr -> state;
 	offset = tknzr -> offset;
 
+	// fail before buffering more of an overlong token
+	if (tknzr -> max_length && tknzr -> buffer_len > tknzr -> max_length) {
+		goto token_too_long;
+	}
+
 	// ensure buffer space for worst case
-	if (json5_tokenizer_ensure_buffer_space (tknzr, size * 2) != 0) {
+	if (json5_tokenizer_ensure_buffer_space (tknzr, (end - chars) * 2) != 0) {
 		goto alloc_error;
 	}
 
-	do {
+	if (tknzr -> pending.again) {
+		tknzr -> pending.again = 0;
+		c = tknzr -> pending.c;
+		char_type = tknzr -> pending.type;
+		goto handle_state;
+	}
+
+	for (;;) {
 		if (tknzr -> mb_char.count) {
-			if (size == 0) {
-				goto unexpected_char;
-			}
-			else if (chars >= end) {
+			if (chars >= end) {
+				if (final) {
+					char_type = JSON5_TOK_END;
+					goto invalid_byte;
+				}
+
 				break;
 			}
 			else {
@@ -498,7 +546,7 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 				continue;
 			}
 		}
-		else if (size == 0) {
+		else if (final) {
 			c = -1;
 		}
 		else {
@@ -553,8 +601,7 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 			offset.colno ++;
 		}
 
-		int again;
-		int accept;
+		handle_state:
 
 		do {
 			again = 0;
@@ -782,7 +829,7 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 				}
 				case JSON5_STATE_STRING_HEXCHAR:
 				case JSON5_STATE_STRING_HEXCHAR_BEGIN: {
-					if (c < 128) {
+					if (c >= 0 && c < 128) {
 						if (char_types [c].hex) {
 							value = char_types [c].hex & HEX_VAL_MASK;
 						}
@@ -822,7 +869,7 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 				}
 				case JSON5_STATE_STRING_HEXCHAR_SURR:
 				case JSON5_STATE_STRING_HEXCHAR_SURR_BEGIN: {
-					if (c < 128) {
+					if (c >= 0 && c < 128) {
 						if (char_types [c].hex) {
 							value = char_types [c].hex & HEX_VAL_MASK;
 						}
@@ -1076,7 +1123,9 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 							break;
 						}
 						default: {
+							// may be another '*' or end of input
 							state = JSON5_STATE_COMMENT_ML;
+							again = 1;
 							break;
 						}
 					}
@@ -1086,6 +1135,10 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 					if (char_type == JSON5_TOK_LINEBREAK) {
 						state = JSON5_STATE_NONE;
 					}
+					else if (char_type == JSON5_TOK_END) {
+						state = JSON5_STATE_NONE;
+						again = 1;
+					}
 					break;
 				}
 				default: {
@@ -1098,7 +1151,8 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 				case JSON5_STATE_NAME:
 				case JSON5_STATE_NAME_SIGN:
 				case JSON5_STATE_STRING: {
-					if (tknzr -> mb_char.length) {
+					// multibyte buffer may be left over from a skipped character
+					if (c >= 128 && tknzr -> mb_char.length) {
 						json5_tokenizer_put_mb_chars (tknzr);
 					}
 					else {
@@ -1216,11 +1270,13 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 			}
 
 			if (accept) {
-				int res;
-
 				token = &tknzr -> token;
 				token -> length = &tknzr -> buffer [tknzr -> buffer_len] - token -> token;
 
+				if (tknzr -> max_length && token -> length > tknzr -> max_length) {
+					goto token_too_long;
+				}
+
 				json5_tokenizer_end_buffer (tknzr);
 
 				switch (token -> type) {
@@ -1266,18 +1322,32 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 					}
 				}
 
-				if ((res = put_token (&tknzr -> token, arg)) != 0) {
-					json5_tokenizer_set_error (tknzr, "User error: %d", res);
-					goto error;
+				// reprocess current char on next call
+				if (again) {
+					tknzr -> pending.again = 1;
+					tknzr -> pending.c = c;
+					tknzr -> pending.type = char_type;
 				}
+
+				tknzr -> state = state;
+				tknzr -> offset = offset;
+				*chars_ref = chars;
+				*out_token = token;
+
+				return 1;
 			}
 		}
 		while (again);
+
+		// end of input was handled
+		if (c < 0) {
+			break;
+		}
 	}
-	while (chars < end);
 
 	tknzr -> state = state;
 	tknzr -> offset = offset;
+	*chars_ref = chars;
 
 	return 0;
 
@@ -1360,6 +1430,12 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 		goto error;
 	}
 
+	token_too_long: {
+		json5_tokenizer_set_error (tknzr, "String exceeds maximum length of %zu bytes on line %d:%d",
+			tknzr -> max_length, tknzr -> token.offset.lineno + 1, tknzr -> token.offset.colno);
+		goto error;
+	}
+
 	alloc_error: {
 		json5_tokenizer_set_error (tknzr, "Allocation error");
 		goto error;
@@ -1375,21 +1451,36 @@ static int json5_tokenizer_put_chars_chunk (json5_tokenizer * tknzr, uint8_t con
 /**
  * Splits input chars into smaller chunks for better buffer usage
  */
-int json5_tokenizer_put_chars (json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_put_token_func put_token, void * arg) {
-	int res = 0;
+int json5_tokenizer_next_token (json5_tokenizer * tknzr, uint8_t const ** chars, uint8_t const * end, int final, json5_token const ** out_token) {
+	int res;
+	size_t const max_size = 1024;
+	uint8_t const * chunk_end;
 
 	do {
-		size_t const max_size = 1024;
-		size_t chunk_size = size > max_size ? max_size : size;
+		chunk_end = (size_t) (end - *chars) > max_size ? *chars + max_size : end;
 
-		if ((res = json5_tokenizer_put_chars_chunk (tknzr, chars, chunk_size, put_token, arg)) != 0) {
-			break;
+		if ((res = json5_tokenizer_scan (tknzr, chars, chunk_end, final && chunk_end == end, out_token)) != 0) {
+			return res;
 		}
+	}
+	while (*chars < end);
+
+	return 0;
+}
 
-		chars += chunk_size;
-		size -= chunk_size;
+int json5_tokenizer_put_chars (json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_put_token_func put_token, void * arg) {
+	int res;
+	json5_token const * token;
+	uint8_t const * end = &chars [size];
+
+	while ((res = json5_tokenizer_next_token (tknzr, &chars, end, size == 0, &token)) > 0) {
+		if ((res = put_token (token, arg)) != 0) {
+			json5_tokenizer_set_error (tknzr, "User error: %d", res);
+			tknzr -> state = JSON5_STATE_ERROR;
+
+			return -1;
+		}
 	}
-	while (size);
 
 	return res;
 }
@@ -1401,3 +1492,70 @@ char const * json5_tokenizer_get_error (json5_tokenizer const * tknzr) {
 
 	return NULL;
 }
+
+int json5_token_format_error (json5_token const * token, char * error, size_t size) {
+	char const * name = "token";
+
+	switch (token -> type) {
+		case JSON5_TOK_OBJ_OPEN: {
+			name = "'{'";
+			break;
+		}
+		case JSON5_TOK_OBJ_CLOSE: {
+			name = "'}'";
+			break;
+		}
+		case JSON5_TOK_ARR_OPEN: {
+			name = "'['";
+			break;
+		}
+		case JSON5_TOK_ARR_CLOSE: {
+			name = "']'";
+			break;
+		}
+		case JSON5_TOK_COMMA: {
+			name = "','";
+			break;
+		}
+		case JSON5_TOK_COLON: {
+			name = "':'";
+			break;
+		}
+		case JSON5_TOK_STRING: {
+			name = "string";
+			break;
+		}
+		case JSON5_TOK_NUMBER:
+		case JSON5_TOK_NUMBER_FLOAT:
+		case JSON5_TOK_NUMBER_BOOL: {
+			name = "number";
+			break;
+		}
+		case JSON5_TOK_NAME: {
+			name = "identifier";
+			break;
+		}
+		case JSON5_TOK_INFINITY: {
+			name = "'Infinity'";
+			break;
+		}
+		case JSON5_TOK_NAN: {
+			name = "'NaN'";
+			break;
+		}
+		case JSON5_TOK_NULL: {
+			name = "'null'";
+			break;
+		}
+		case JSON5_TOK_END: {
+			return snprintf (error, size, "Premature end of file");
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+
+	return snprintf (error, size, "Unexpected %s on line %d:%d",
+		name, token -> offset.lineno + 1, token -> offset.colno);
+}
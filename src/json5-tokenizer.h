@@ -120,6 +120,7 @@ typedef struct {
 	size_t buffer_len;
 	size_t buffer_cap;
 	uint8_t * buffer;
+	size_t max_length;
 	json5_off offset;
 	struct {
 		uint8_t length;
@@ -127,6 +128,11 @@ typedef struct {
 		unsigned value;
 		uint8_t chars [4];
 	} mb_char;
+	struct {
+		int again;
+		int c;
+		json5_tok_type type;
+	} pending;
 	json5_token token;
 } json5_tokenizer;
 
@@ -155,6 +161,24 @@ extern void json5_tokenizer_reset (json5_tokenizer * tknzr);
  */
 extern void json5_tokenizer_destroy (json5_tokenizer * tknzr);
 
+/**
+ * Shrink the buffer to its initial size if it is larger than @p max_size
+ * bytes.
+ *
+ * Resets the tokenizer if the buffer is shrunk. Returns 1 if the buffer was
+ * shrunk or 0 otherwise.
+ */
+extern int json5_tokenizer_trim (json5_tokenizer * tknzr, size_t max_size);
+
+/**
+ * Set the maximum length of string and identifier tokens in bytes.
+ *
+ * Longer tokens are rejected as soon as they exceed the length, so they are
+ * never buffered completely. Pass 0 to disable the limit. The limit is kept
+ * when the tokenizer is reset.
+ */
+extern void json5_tokenizer_set_max_length (json5_tokenizer * tknzr, size_t max_length);
+
 /**
  * Push Unicode characters to the tokenizer.
  *
@@ -162,7 +186,26 @@ extern void json5_tokenizer_destroy (json5_tokenizer * tknzr);
  */
 extern int json5_tokenizer_put_chars (json5_tokenizer * tknzr, uint8_t const * chars, size_t size, json5_put_token_func put_token, void * arg);
 
+/**
+ * Scan Unicode characters until the next token is complete.
+ *
+ * @p chars is advanced past the consumed characters. If @p final is not 0,
+ * the characters up to @p end are the last ones and the end of input is
+ * tokenized after them. The token is only valid until the next call.
+ *
+ * Returns 1 if a token was written to @p out_token, 0 if all characters are
+ * consumed or the end of input was reached, or -1 if an error occurred.
+ */
+extern int json5_tokenizer_next_token (json5_tokenizer * tknzr, uint8_t const ** chars, uint8_t const * end, int final, json5_token const ** out_token);
+
 /**
  * Returns the last error message or NULL if no error is present.
  */
 extern char const * json5_tokenizer_get_error (json5_tokenizer const * tknzr);
+
+/**
+ * Write the error message for an unexpected token to @p error.
+ *
+ * Returns the message length like `snprintf`.
+ */
+extern int json5_token_format_error (json5_token const * token, char * error, size_t size);
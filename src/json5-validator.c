@@ -0,0 +1,1145 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "json5-validator.h"
+#include "unicode-table.h"
+
+#define INIT_STACK_CAP 256
+#define INIT_INDEX_CAP 64
+#define NO_PARENT ((size_t) -1)
+
+/**
+ * Defines character classes
+ */
+typedef enum {
+	JSON5_CLASS_OTHER = 0,
+	JSON5_CLASS_SPACE,
+	JSON5_CLASS_LINEBREAK,
+	JSON5_CLASS_NAME,       // identifier start
+	JSON5_CLASS_NAME_OTHER, // identifier part
+	JSON5_CLASS_DIGIT,
+	JSON5_CLASS_PUNCT,      // single character token
+	JSON5_CLASS_STRING,
+	JSON5_CLASS_SIGN,
+	JSON5_CLASS_PERIOD,
+	JSON5_CLASS_COMMENT,
+} json5_char_class;
+
+/**
+ * Defines validator token types
+ */
+typedef enum {
+	JSON5_VTOK_END = 0,
+	JSON5_VTOK_OBJ_OPEN,
+	JSON5_VTOK_OBJ_CLOSE,
+	JSON5_VTOK_ARR_OPEN,
+	JSON5_VTOK_ARR_CLOSE,
+	JSON5_VTOK_COMMA,
+	JSON5_VTOK_COLON,
+	JSON5_VTOK_STRING,  // value or key
+	JSON5_VTOK_NUMBER,  // value
+	JSON5_VTOK_KEYWORD, // value or key
+	JSON5_VTOK_NAME,    // key
+} json5_vtok_type;
+
+/**
+ * Defines validator states
+ */
+typedef enum {
+	JSON5_STATE_VALUE = 0,
+	JSON5_STATE_ARR_VAL,
+	JSON5_STATE_ARR_SEP,
+	JSON5_STATE_OBJ_KEY,
+	JSON5_STATE_OBJ_KEY_SEP,
+	JSON5_STATE_OBJ_SEP,
+	JSON5_STATE_ROOT,
+} json5_validator_state;
+
+typedef struct {
+	uint8_t const * start;
+	uint8_t const * chars;
+	uint8_t const * end;
+	uint8_t const * token;
+	uint8_t const * error_pos;
+	char const * error;
+	json5_index * index;
+	size_t parent;
+	int escaped;
+} json5_validator;
+
+/**
+ * Defines ASCII character classes
+ */
+static uint8_t const char_classes [128] = {
+	[' ']  = JSON5_CLASS_SPACE,
+	['\t'] = JSON5_CLASS_SPACE,
+	['\f'] = JSON5_CLASS_SPACE,
+	['\v'] = JSON5_CLASS_SPACE,
+	['\n'] = JSON5_CLASS_LINEBREAK,
+	['\r'] = JSON5_CLASS_LINEBREAK,
+	['{']  = JSON5_CLASS_PUNCT,
+	['}']  = JSON5_CLASS_PUNCT,
+	['[']  = JSON5_CLASS_PUNCT,
+	[']']  = JSON5_CLASS_PUNCT,
+	[',']  = JSON5_CLASS_PUNCT,
+	[':']  = JSON5_CLASS_PUNCT,
+	['"']  = JSON5_CLASS_STRING,
+	['\''] = JSON5_CLASS_STRING,
+	['+']  = JSON5_CLASS_SIGN,
+	['-']  = JSON5_CLASS_SIGN,
+	['.']  = JSON5_CLASS_PERIOD,
+	['/']  = JSON5_CLASS_COMMENT,
+	['0'] = JSON5_CLASS_DIGIT, ['1'] = JSON5_CLASS_DIGIT, ['2'] = JSON5_CLASS_DIGIT,
+	['3'] = JSON5_CLASS_DIGIT, ['4'] = JSON5_CLASS_DIGIT, ['5'] = JSON5_CLASS_DIGIT,
+	['6'] = JSON5_CLASS_DIGIT, ['7'] = JSON5_CLASS_DIGIT, ['8'] = JSON5_CLASS_DIGIT,
+	['9'] = JSON5_CLASS_DIGIT,
+	['A'] = JSON5_CLASS_NAME, ['B'] = JSON5_CLASS_NAME, ['C'] = JSON5_CLASS_NAME,
+	['D'] = JSON5_CLASS_NAME, ['E'] = JSON5_CLASS_NAME, ['F'] = JSON5_CLASS_NAME,
+	['G'] = JSON5_CLASS_NAME, ['H'] = JSON5_CLASS_NAME, ['I'] = JSON5_CLASS_NAME,
+	['J'] = JSON5_CLASS_NAME, ['K'] = JSON5_CLASS_NAME, ['L'] = JSON5_CLASS_NAME,
+	['M'] = JSON5_CLASS_NAME, ['N'] = JSON5_CLASS_NAME, ['O'] = JSON5_CLASS_NAME,
+	['P'] = JSON5_CLASS_NAME, ['Q'] = JSON5_CLASS_NAME, ['R'] = JSON5_CLASS_NAME,
+	['S'] = JSON5_CLASS_NAME, ['T'] = JSON5_CLASS_NAME, ['U'] = JSON5_CLASS_NAME,
+	['V'] = JSON5_CLASS_NAME, ['W'] = JSON5_CLASS_NAME, ['X'] = JSON5_CLASS_NAME,
+	['Y'] = JSON5_CLASS_NAME, ['Z'] = JSON5_CLASS_NAME,
+	['a'] = JSON5_CLASS_NAME, ['b'] = JSON5_CLASS_NAME, ['c'] = JSON5_CLASS_NAME,
+	['d'] = JSON5_CLASS_NAME, ['e'] = JSON5_CLASS_NAME, ['f'] = JSON5_CLASS_NAME,
+	['g'] = JSON5_CLASS_NAME, ['h'] = JSON5_CLASS_NAME, ['i'] = JSON5_CLASS_NAME,
+	['j'] = JSON5_CLASS_NAME, ['k'] = JSON5_CLASS_NAME, ['l'] = JSON5_CLASS_NAME,
+	['m'] = JSON5_CLASS_NAME, ['n'] = JSON5_CLASS_NAME, ['o'] = JSON5_CLASS_NAME,
+	['p'] = JSON5_CLASS_NAME, ['q'] = JSON5_CLASS_NAME, ['r'] = JSON5_CLASS_NAME,
+	['s'] = JSON5_CLASS_NAME, ['t'] = JSON5_CLASS_NAME, ['u'] = JSON5_CLASS_NAME,
+	['v'] = JSON5_CLASS_NAME, ['w'] = JSON5_CLASS_NAME, ['x'] = JSON5_CLASS_NAME,
+	['y'] = JSON5_CLASS_NAME, ['z'] = JSON5_CLASS_NAME,
+	['_'] = JSON5_CLASS_NAME, ['$'] = JSON5_CLASS_NAME,
+};
+
+/**
+ * Defines ASCII characters not ending a fast string scan
+ */
+static uint8_t const string_chars [128] = {
+	[0x00] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	[0x10] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	[0x20] = 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, // '"', '\''
+	[0x30] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	[0x40] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	[0x50] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, // '\\'
+	[0x60] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	[0x70] = 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+};
+
+static int json5_validator_set_error (json5_validator * v, uint8_t const * pos, char const * msg)
+{
+	v -> error = msg;
+	v -> error_pos = pos;
+
+	return -1;
+}
+
+/**
+ * Decode a multibyte character with the same rules as the tokenizer
+ *
+ * Returns the sequence length in bytes or 0 if the sequence is invalid.
+ */
+static size_t json5_validator_decode (uint8_t const * chars, uint8_t const * end, unsigned * out_c)
+{
+	unsigned c = chars [0];
+	size_t count;
+
+	if ((c & 0xE0) == 0xC0) {
+		c &= 0x1F;
+		count = 1;
+	}
+	else if ((c & 0xF0) == 0xE0) {
+		c &= 0x0F;
+		count = 2;
+	}
+	else if ((c & 0xF8) == 0xF0) {
+		c &= 0x07;
+		count = 3;
+	}
+	else {
+		return 0;
+	}
+
+	if ((size_t) (end - chars) <= count) {
+		return 0;
+	}
+
+	for (size_t i = 1; i <= count; i ++) {
+		if ((chars [i] & 0xC0) != 0x80) {
+			return 0;
+		}
+
+		c = (c << 6) | (chars [i] & 0x3F);
+	}
+
+	*out_c = c;
+
+	return count + 1;
+}
+
+static json5_char_class json5_validator_class (unsigned c)
+{
+	if (c < 128) {
+		return char_classes [c];
+	}
+
+	switch (json5_ut_lookup_glyph (c) -> category) {
+		case JSON5_UT_CATEGORY_LETTER_UPPERCASE:
+		case JSON5_UT_CATEGORY_LETTER_LOWERCASE:
+		case JSON5_UT_CATEGORY_LETTER_TITLECASE:
+		case JSON5_UT_CATEGORY_LETTER_MODIFIER:
+		case JSON5_UT_CATEGORY_LETTER_OTHER:
+		case JSON5_UT_CATEGORY_NUMBER_LETTER: {
+			return JSON5_CLASS_NAME;
+			break;
+		}
+		case JSON5_UT_CATEGORY_NUMBER_DECIMAL_DIGIT:
+		case JSON5_UT_CATEGORY_MARK_NONSPACING:
+		case JSON5_UT_CATEGORY_MARK_SPACING_COMBINING: {
+			return JSON5_CLASS_NAME_OTHER;
+			break;
+		}
+		case JSON5_UT_CATEGORY_SEPARATOR_PARAGRAPH: {
+			return JSON5_CLASS_LINEBREAK;
+			break;
+		}
+		case JSON5_UT_CATEGORY_SEPARATOR_SPACE: {
+			return JSON5_CLASS_SPACE;
+			break;
+		}
+		default: {
+			return JSON5_CLASS_OTHER;
+			break;
+		}
+	}
+}
+
+/**
+ * Get the class of the character at @p chars
+ *
+ * Sets @p out_len to the character length in bytes. Returns -1 if the
+ * character is an invalid multibyte sequence.
+ */
+static int json5_validator_peek (uint8_t const * chars, uint8_t const * end, size_t * out_len)
+{
+	unsigned c = chars [0];
+
+	if (c < 128) {
+		*out_len = 1;
+
+		return char_classes [c];
+	}
+
+	if (!(*out_len = json5_validator_decode (chars, end, &c))) {
+		return -1;
+	}
+
+	return json5_validator_class (c);
+}
+
+/**
+ * Skip multibyte characters until an ASCII character or the end is reached
+ */
+static int json5_validator_skip_mb (json5_validator * v, uint8_t const ** chars_ref)
+{
+	size_t len;
+	unsigned c;
+	uint8_t const * chars = *chars_ref;
+
+	while (chars < v -> end && *chars >= 128) {
+		if (!(len = json5_validator_decode (chars, v -> end, &c))) {
+			return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+		}
+
+		chars += len;
+	}
+
+	*chars_ref = chars;
+
+	return 0;
+}
+
+/**
+ * Skip spaces, linebreaks and comments
+ */
+static int json5_validator_skip_space (json5_validator * v)
+{
+	int cls;
+	size_t len;
+	uint8_t const * chars = v -> chars;
+	uint8_t const * end = v -> end;
+
+	while (chars < end) {
+		if ((cls = json5_validator_peek (chars, end, &len)) < 0) {
+			return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+		}
+
+		switch (cls) {
+			case JSON5_CLASS_SPACE:
+			case JSON5_CLASS_LINEBREAK: {
+				chars += len;
+				break;
+			}
+			case JSON5_CLASS_COMMENT: {
+				if (chars + 1 >= end) {
+					return json5_validator_set_error (v, end, "Premature end of file");
+				}
+
+				if (chars [1] == '/') {
+					// single line comment ends at linebreak
+					for (chars += 2; chars < end;) {
+						if (*chars < 128) {
+							if (*chars ++ == '\n' || chars [-1] == '\r') {
+								break;
+							}
+						}
+						else if ((cls = json5_validator_peek (chars, end, &len)) < 0) {
+							return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+						}
+						else {
+							chars += len;
+
+							if (cls == JSON5_CLASS_LINEBREAK) {
+								break;
+							}
+						}
+					}
+				}
+				else if (chars [1] == '*') {
+					// multiline comment ends at "*/"
+					for (chars += 2;;) {
+						if (chars >= end) {
+							return json5_validator_set_error (v, end, "Premature end of file");
+						}
+
+						if (*chars < 128) {
+							if (*chars ++ == '*' && chars < end && *chars == '/') {
+								chars ++;
+								break;
+							}
+						}
+						else if (json5_validator_skip_mb (v, &chars) != 0) {
+							return -1;
+						}
+					}
+				}
+				else {
+					return json5_validator_set_error (v, chars + 1, "Unexpected character");
+				}
+
+				break;
+			}
+			default: {
+				v -> chars = chars;
+
+				return 0;
+				break;
+			}
+		}
+	}
+
+	v -> chars = chars;
+
+	return 0;
+}
+
+static int json5_validator_hex (json5_validator * v, uint8_t const ** chars_ref, int count, unsigned * out_value)
+{
+	unsigned c;
+	unsigned value = 0;
+	uint8_t const * chars = *chars_ref;
+
+	for (int i = 0; i < count; i ++) {
+		if (chars >= v -> end) {
+			return json5_validator_set_error (v, chars, "Premature end of hex sequence");
+		}
+
+		c = *chars;
+
+		if (c >= '0' && c <= '9') {
+			c -= '0';
+		}
+		else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+			c = (c | 0x20) - 'a' + 10;
+		}
+		else {
+			return json5_validator_set_error (v, chars, "Invalid hex character");
+		}
+
+		value = (value << 4) | c;
+		chars ++;
+	}
+
+	*chars_ref = chars;
+	*out_value = value;
+
+	return 0;
+}
+
+/**
+ * Validate an escape sequence after '\'
+ */
+static int json5_validator_escape (json5_validator * v, uint8_t const ** chars_ref)
+{
+	int cls;
+	size_t len;
+	unsigned value;
+	uint8_t const * chars = *chars_ref;
+	uint8_t const * end = v -> end;
+
+	if (chars >= end) {
+		return json5_validator_set_error (v, chars, "Premature end of file for string");
+	}
+
+	if ((cls = json5_validator_peek (chars, end, &len)) < 0) {
+		return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+	}
+
+	switch (cls) {
+		case JSON5_CLASS_SPACE:
+		case JSON5_CLASS_LINEBREAK: {
+			// line continuation: spaces followed by a linebreak
+			for (;;) {
+				if (chars >= end) {
+					return json5_validator_set_error (v, chars, "Premature end of file");
+				}
+
+				if ((cls = json5_validator_peek (chars, end, &len)) < 0) {
+					return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+				}
+
+				if (cls == JSON5_CLASS_LINEBREAK && *chars != '\r') {
+					chars += len;
+					break;
+				}
+				else if (cls == JSON5_CLASS_SPACE || cls == JSON5_CLASS_LINEBREAK) {
+					chars += len;
+				}
+				else {
+					return json5_validator_set_error (v, chars, "Unexpected character");
+				}
+			}
+
+			break;
+		}
+		default: {
+			chars += len;
+
+			if (chars [-1] == 'x') {
+				if (json5_validator_hex (v, &chars, 2, &value) != 0) {
+					return -1;
+				}
+			}
+			else if (chars [-1] == 'u') {
+				if (json5_validator_hex (v, &chars, 4, &value) != 0) {
+					return -1;
+				}
+
+				// high surrogate has to be followed by low surrogate
+				if ((value & 0xFC00) == 0xD800) {
+					if (chars + 1 >= end || chars [0] != '\\') {
+						return json5_validator_set_error (v, chars, "Unicode error: Expected low surrogate sequence");
+					}
+
+					if (chars [1] != 'u') {
+						return json5_validator_set_error (v, chars + 1, "Unexpected character");
+					}
+
+					chars += 2;
+
+					if (json5_validator_hex (v, &chars, 4, &value) != 0) {
+						return -1;
+					}
+
+					if ((value & 0xFC00) != 0xDC00) {
+						return json5_validator_set_error (v, chars, "Unicode error: Expected low surrogate sequence");
+					}
+				}
+			}
+
+			break;
+		}
+	}
+
+	*chars_ref = chars;
+
+	return 0;
+}
+
+static int json5_validator_string (json5_validator * v)
+{
+	uint8_t const * chars = v -> chars;
+	uint8_t const * end = v -> end;
+	uint8_t quote = *chars ++;
+
+	for (;;) {
+		while (chars < end && *chars < 128 && string_chars [*chars]) {
+			chars ++;
+		}
+
+		if (chars >= end) {
+			return json5_validator_set_error (v, v -> chars, "Premature end of file for string");
+		}
+
+		if (*chars == quote) {
+			chars ++;
+			break;
+		}
+		else if (*chars == '\\') {
+			chars ++;
+			v -> escaped = 1;
+
+			if (json5_validator_escape (v, &chars) != 0) {
+				return -1;
+			}
+		}
+		else if (*chars < 128) {
+			// other quote
+			chars ++;
+		}
+		else if (json5_validator_skip_mb (v, &chars) != 0) {
+			return -1;
+		}
+	}
+
+	v -> chars = chars;
+
+	return 0;
+}
+
+/**
+ * Scan an identifier
+ *
+ * Returns 1 if it is a keyword and 0 otherwise.
+ */
+static int json5_validator_name (json5_validator * v, uint8_t const ** chars_ref)
+{
+	int cls;
+	size_t len;
+	uint8_t const * start = *chars_ref;
+	uint8_t const * chars = start;
+
+	while (chars < v -> end) {
+		cls = json5_validator_peek (chars, v -> end, &len);
+
+		if (cls != JSON5_CLASS_NAME && cls != JSON5_CLASS_NAME_OTHER && cls != JSON5_CLASS_DIGIT) {
+			break;
+		}
+
+		chars += len;
+	}
+
+	*chars_ref = chars;
+	len = chars - start;
+
+	switch (len) {
+		case 3: {
+			return memcmp (start, "NaN", 3) == 0;
+			break;
+		}
+		case 4: {
+			return memcmp (start, "true", 4) == 0 || memcmp (start, "null", 4) == 0;
+			break;
+		}
+		case 5: {
+			return memcmp (start, "false", 5) == 0;
+			break;
+		}
+		case 8: {
+			return memcmp (start, "Infinity", 8) == 0;
+			break;
+		}
+		default: {
+			return 0;
+			break;
+		}
+	}
+}
+
+/**
+ * Check if the character following a number is part of a hex number
+ */
+static int json5_validator_is_name (uint8_t const * chars, uint8_t const * end)
+{
+	size_t len;
+
+	return chars < end && json5_validator_peek (chars, end, &len) == JSON5_CLASS_NAME;
+}
+
+static int json5_validator_number (json5_validator * v, json5_vtok_type * out_type)
+{
+	size_t digits = 0;
+	uint8_t const * chars = v -> chars;
+	uint8_t const * end = v -> end;
+	uint8_t const * start;
+
+	*out_type = JSON5_VTOK_NUMBER;
+
+	if (*chars == '+' || *chars == '-') {
+		chars ++;
+
+		if (chars >= end) {
+			return json5_validator_set_error (v, chars, "Premature end of file");
+		}
+
+		// signed keywords
+		if (json5_validator_is_name (chars, end)) {
+			start = chars;
+			json5_validator_name (v, &chars);
+
+			if (!((chars - start == 4 && memcmp (start, "null", 4) == 0) ||
+				(chars - start == 3 && memcmp (start, "NaN", 3) == 0) ||
+				(chars - start == 8 && memcmp (start, "Infinity", 8) == 0))) {
+				return json5_validator_set_error (v, start, "Invalid token");
+			}
+
+			*out_type = JSON5_VTOK_KEYWORD;
+			v -> chars = chars;
+
+			return 0;
+		}
+
+		if (*chars != '.' && (*chars < '0' || *chars > '9')) {
+			return json5_validator_set_error (v, chars, "Unexpected character");
+		}
+	}
+
+	start = chars;
+
+	while (chars < end && *chars >= '0' && *chars <= '9') {
+		chars ++;
+	}
+
+	digits = chars - start;
+
+	if (chars < end && (*chars == 'x' || *chars == 'X')) {
+		if (digits != 1 || *start != '0') {
+			return json5_validator_set_error (v, chars, "Unexpected character");
+		}
+
+		start = ++ chars;
+
+		while (chars < end && ((*chars >= '0' && *chars <= '9') || ((*chars | 0x20) >= 'a' && (*chars | 0x20) <= 'f'))) {
+			chars ++;
+		}
+
+		// identifier characters are not allowed after hex digits
+		if (chars == start || json5_validator_is_name (chars, end) || (chars < end && *chars >= '0' && *chars <= '9')) {
+			return json5_validator_set_error (v, chars, "Invalid hex character");
+		}
+
+		v -> chars = chars;
+
+		return 0;
+	}
+
+	if (chars < end && *chars == '.') {
+		start = ++ chars;
+
+		while (chars < end && *chars >= '0' && *chars <= '9') {
+			chars ++;
+		}
+
+		digits += chars - start;
+
+		if (!digits) {
+			return json5_validator_set_error (v, chars, "Unexpected character");
+		}
+	}
+
+	if (chars < end && (*chars == 'e' || *chars == 'E')) {
+		chars ++;
+
+		if (chars < end && (*chars == '+' || *chars == '-')) {
+			chars ++;
+		}
+
+		start = chars;
+
+		while (chars < end && *chars >= '0' && *chars <= '9') {
+			chars ++;
+		}
+
+		if (chars == start) {
+			return json5_validator_set_error (v, chars, "Unexpected character");
+		}
+	}
+
+	v -> chars = chars;
+
+	return 0;
+}
+
+/**
+ * Scan the next token without converting its value
+ */
+static int json5_validator_next_token (json5_validator * v, json5_vtok_type * out_type)
+{
+	int cls;
+	size_t len;
+	uint8_t const * chars;
+
+	if (json5_validator_skip_space (v) != 0) {
+		return -1;
+	}
+
+	chars = v -> chars;
+	v -> token = chars;
+
+	if (chars >= v -> end) {
+		*out_type = JSON5_VTOK_END;
+
+		return 0;
+	}
+
+	if ((cls = json5_validator_peek (chars, v -> end, &len)) < 0) {
+		return json5_validator_set_error (v, chars, "Invalid byte for Unicode sequence");
+	}
+
+	switch (cls) {
+		case JSON5_CLASS_PUNCT: {
+			switch (*chars) {
+				case '{': {
+					*out_type = JSON5_VTOK_OBJ_OPEN;
+					break;
+				}
+				case '}': {
+					*out_type = JSON5_VTOK_OBJ_CLOSE;
+					break;
+				}
+				case '[': {
+					*out_type = JSON5_VTOK_ARR_OPEN;
+					break;
+				}
+				case ']': {
+					*out_type = JSON5_VTOK_ARR_CLOSE;
+					break;
+				}
+				case ',': {
+					*out_type = JSON5_VTOK_COMMA;
+					break;
+				}
+				default: {
+					*out_type = JSON5_VTOK_COLON;
+					break;
+				}
+			}
+
+			v -> chars ++;
+			break;
+		}
+		case JSON5_CLASS_STRING: {
+			*out_type = JSON5_VTOK_STRING;
+			v -> escaped = 0;
+
+			return json5_validator_string (v);
+			break;
+		}
+		case JSON5_CLASS_DIGIT:
+		case JSON5_CLASS_SIGN:
+		case JSON5_CLASS_PERIOD: {
+			return json5_validator_number (v, out_type);
+			break;
+		}
+		case JSON5_CLASS_NAME: {
+			*out_type = json5_validator_name (v, &v -> chars) ? JSON5_VTOK_KEYWORD : JSON5_VTOK_NAME;
+			break;
+		}
+		default: {
+			return json5_validator_set_error (v, chars, "Unexpected character");
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Append a node for the current token to the index
+ */
+static int json5_validator_add_node (json5_validator * v, json5_vtok_type type, int is_key)
+{
+	size_t new_cap;
+	json5_index_node * nodes;
+	json5_index_node * node;
+	json5_index * index = v -> index;
+	size_t length = v -> chars - v -> token;
+
+	if (index -> len >= index -> cap) {
+		new_cap = index -> cap ? index -> cap * 2 : INIT_INDEX_CAP;
+		nodes = realloc (index -> nodes, new_cap * sizeof (*nodes));
+
+		if (!nodes) {
+			return json5_validator_set_error (v, v -> token, "Allocation error");
+		}
+
+		index -> nodes = nodes;
+		index -> cap = new_cap;
+	}
+
+	if (v -> parent != NO_PARENT) {
+		node = &index -> nodes [v -> parent];
+
+		// objects count keys, arrays count values
+		if (is_key || node -> type == JSON5_NODE_ARRAY) {
+			node -> count ++;
+		}
+	}
+
+	if (!is_key) {
+		index -> values ++;
+	}
+
+	node = &index -> nodes [index -> len];
+	node -> flags = is_key ? JSON5_NODE_KEY : 0;
+	node -> count = 0;
+	node -> offset = v -> token - v -> start;
+	node -> length = length;
+	node -> next = index -> len + 1;
+
+	switch (type) {
+		case JSON5_VTOK_OBJ_OPEN:
+		case JSON5_VTOK_ARR_OPEN: {
+			node -> type = type == JSON5_VTOK_OBJ_OPEN ? JSON5_NODE_OBJECT : JSON5_NODE_ARRAY;
+			// link to parent until the container is closed
+			node -> next = v -> parent;
+			v -> parent = index -> len;
+			break;
+		}
+		case JSON5_VTOK_STRING: {
+			node -> type = JSON5_NODE_STRING;
+			node -> flags |= v -> escaped ? JSON5_NODE_ESCAPED : 0;
+			break;
+		}
+		case JSON5_VTOK_NUMBER: {
+			node -> type = JSON5_NODE_NUMBER;
+			break;
+		}
+		case JSON5_VTOK_KEYWORD: {
+			node -> type = JSON5_NODE_KEYWORD;
+			break;
+		}
+		default: {
+			node -> type = JSON5_NODE_NAME;
+			break;
+		}
+	}
+
+	if ((type == JSON5_VTOK_STRING || type == JSON5_VTOK_NAME) && length > index -> max_string) {
+		index -> max_string = length;
+	}
+
+	index -> len ++;
+
+	return 0;
+}
+
+/**
+ * Set the length and the next node of the current container
+ */
+static void json5_validator_close_node (json5_validator * v)
+{
+	json5_index_node * node = &v -> index -> nodes [v -> parent];
+
+	v -> parent = node -> next;
+	node -> next = v -> index -> len;
+	node -> length = v -> chars - v -> start - node -> offset;
+}
+
+/**
+ * Get line and column of the error position like the tokenizer counts them
+ */
+static void json5_validator_error_pos (json5_validator const * v, uint8_t const * start, json5_validate_error * out_error)
+{
+	int cls;
+	size_t len;
+	int lineno = 1;
+	int colno = 1;
+
+	for (uint8_t const * chars = start; chars < v -> error_pos; chars += len) {
+		if ((cls = json5_validator_peek (chars, v -> end, &len)) < 0) {
+			len = 1;
+		}
+
+		if (cls == JSON5_CLASS_LINEBREAK) {
+			lineno ++;
+			colno = 1;
+		}
+		else {
+			colno ++;
+		}
+	}
+
+	out_error -> message = v -> error;
+	out_error -> offset = v -> error_pos - start;
+	out_error -> lineno = lineno;
+	out_error -> colno = colno;
+}
+
+static int json5_validator_run (uint8_t const * string, size_t size, json5_index * index, json5_validate_error * out_error)
+{
+	int res = -1;
+	json5_vtok_type type;
+	json5_validator v;
+	json5_validator_state state = JSON5_STATE_VALUE;
+	uint8_t local_stack [INIT_STACK_CAP];
+	uint8_t * stack = local_stack;
+	uint8_t * new_stack;
+	size_t stack_len = 0;
+	size_t stack_cap = INIT_STACK_CAP;
+
+	v.start = string;
+	v.chars = string;
+	v.end = &string [size];
+	v.token = string;
+	v.error = NULL;
+	v.error_pos = NULL;
+	v.index = index;
+	v.parent = NO_PARENT;
+	v.escaped = 0;
+
+	for (;;) {
+		if (json5_validator_next_token (&v, &type) != 0) {
+			goto cleanup;
+		}
+
+		switch (state) {
+			case JSON5_STATE_VALUE:
+			case JSON5_STATE_ARR_VAL: {
+				switch (type) {
+					case JSON5_VTOK_STRING:
+					case JSON5_VTOK_NUMBER:
+					case JSON5_VTOK_KEYWORD: {
+						if (index && json5_validator_add_node (&v, type, 0) != 0) {
+							goto cleanup;
+						}
+
+						goto end_value;
+						break;
+					}
+					case JSON5_VTOK_ARR_OPEN:
+					case JSON5_VTOK_OBJ_OPEN: {
+						if (stack_len >= stack_cap) {
+							new_stack = malloc (stack_cap * 2);
+
+							if (!new_stack) {
+								json5_validator_set_error (&v, v.chars, "Allocation error");
+								goto cleanup;
+							}
+
+							memcpy (new_stack, stack, stack_len);
+
+							if (stack != local_stack) {
+								free (stack);
+							}
+
+							stack = new_stack;
+							stack_cap *= 2;
+						}
+
+						stack [stack_len ++] = type;
+
+						if (index) {
+							if (json5_validator_add_node (&v, type, 0) != 0) {
+								goto cleanup;
+							}
+
+							if (stack_len > index -> depth) {
+								index -> depth = stack_len;
+							}
+						}
+
+						state = type == JSON5_VTOK_ARR_OPEN ? JSON5_STATE_ARR_VAL : JSON5_STATE_OBJ_KEY;
+						break;
+					}
+					case JSON5_VTOK_ARR_CLOSE: {
+						if (state == JSON5_STATE_ARR_VAL) {
+							goto end_container;
+						}
+
+						goto unexpected_token;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+
+				break;
+			}
+			case JSON5_STATE_ARR_SEP: {
+				switch (type) {
+					case JSON5_VTOK_COMMA: {
+						state = JSON5_STATE_ARR_VAL;
+						break;
+					}
+					case JSON5_VTOK_ARR_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+
+				break;
+			}
+			case JSON5_STATE_OBJ_KEY: {
+				switch (type) {
+					case JSON5_VTOK_STRING:
+					case JSON5_VTOK_KEYWORD:
+					case JSON5_VTOK_NAME: {
+						if (index && json5_validator_add_node (&v, type, 1) != 0) {
+							goto cleanup;
+						}
+
+						state = JSON5_STATE_OBJ_KEY_SEP;
+						break;
+					}
+					case JSON5_VTOK_OBJ_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+
+				break;
+			}
+			case JSON5_STATE_OBJ_KEY_SEP: {
+				if (type != JSON5_VTOK_COLON) {
+					goto unexpected_token;
+				}
+
+				state = JSON5_STATE_VALUE;
+				break;
+			}
+			case JSON5_STATE_OBJ_SEP: {
+				switch (type) {
+					case JSON5_VTOK_COMMA: {
+						state = JSON5_STATE_OBJ_KEY;
+						break;
+					}
+					case JSON5_VTOK_OBJ_CLOSE: {
+						goto end_container;
+						break;
+					}
+					default: {
+						goto unexpected_token;
+						break;
+					}
+				}
+
+				break;
+			}
+			case JSON5_STATE_ROOT: {
+				if (type != JSON5_VTOK_END) {
+					json5_validator_set_error (&v, v.chars - 1, "Extra token in root context");
+					goto cleanup;
+				}
+
+				res = 0;
+				goto cleanup;
+				break;
+			}
+		}
+
+		continue;
+
+		end_container: {
+			stack_len --;
+
+			if (index) {
+				json5_validator_close_node (&v);
+			}
+		}
+
+		end_value: {
+			if (!stack_len) {
+				state = JSON5_STATE_ROOT;
+			}
+			else if (stack [stack_len - 1] == JSON5_VTOK_ARR_OPEN) {
+				state = JSON5_STATE_ARR_SEP;
+			}
+			else {
+				state = JSON5_STATE_OBJ_SEP;
+			}
+		}
+	}
+
+	unexpected_token: {
+		if (type == JSON5_VTOK_END) {
+			json5_validator_set_error (&v, v.chars, "Premature end of file");
+		}
+		else {
+			json5_validator_set_error (&v, v.chars - 1, "Unexpected token");
+		}
+	}
+
+	cleanup: {
+		if (stack != local_stack) {
+			free (stack);
+		}
+
+		if (res != 0 && out_error) {
+			json5_validator_error_pos (&v, string, out_error);
+		}
+	}
+
+	return res;
+}
+
+int json5_validate (uint8_t const * string, size_t size, json5_validate_error * out_error)
+{
+	return json5_validator_run (string, size, NULL, out_error);
+}
+
+int json5_validate_index (uint8_t const * string, size_t size, json5_index * index, json5_validate_error * out_error)
+{
+	index -> len = 0;
+	index -> depth = 0;
+	index -> values = 0;
+	index -> max_string = 0;
+
+	if (json5_validator_run (string, size, index, out_error) != 0) {
+		index -> len = 0;
+
+		return -1;
+	}
+
+	return 0;
+}
+
+void json5_index_destroy (json5_index * index)
+{
+	free (index -> nodes);
+	memset (index, 0, sizeof (*index));
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2016 Simon Schoenenberger
+ * https://github.com/detomon/json5
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Defines a validation error.
+ */
+typedef struct {
+	char const * message; ///< The error message.
+	size_t offset;        ///< The byte offset of the error.
+	int lineno;           ///< The line number starting at 1.
+	int colno;            ///< The column number in characters starting at 1.
+} json5_validate_error;
+
+/**
+ * Defines index node types.
+ */
+typedef enum {
+	JSON5_NODE_OBJECT = 0, ///< {...}
+	JSON5_NODE_ARRAY,      ///< [...]
+	JSON5_NODE_STRING,     ///< "abc"
+	JSON5_NODE_NUMBER,     ///< 42, -1.5e3, 0x1F
+	JSON5_NODE_KEYWORD,    ///< true, false, null, NaN, Infinity
+	JSON5_NODE_NAME,       ///< Unquoted object key.
+} json5_node_type;
+
+/**
+ * Defines index node flags.
+ */
+#define JSON5_NODE_ESCAPED 1 ///< String contains escape sequences.
+#define JSON5_NODE_KEY     2 ///< Node is an object key.
+
+/**
+ * Defines an index node.
+ *
+ * Nodes are stored in document order. Object members are stored as key node
+ * followed by the value node.
+ */
+typedef struct {
+	uint8_t type;   ///< The node type.
+	uint8_t flags;  ///< The node flags.
+	uint32_t count; ///< Number of items or properties of containers.
+	size_t offset;  ///< Byte offset of the token or opening bracket.
+	size_t length;  ///< Byte length of the token or the whole container.
+	size_t next;    ///< Index of the node following the node's subtree.
+} json5_index_node;
+
+/**
+ * Defines a structural index of a JSON string.
+ */
+typedef struct {
+	json5_index_node * nodes; ///< The nodes.
+	size_t len;               ///< Number of nodes.
+	size_t cap;               ///< Node capacity.
+	size_t depth;             ///< Maximum container nesting.
+	size_t values;            ///< Number of values excluding keys.
+	size_t max_string;        ///< Byte length of the longest string or name.
+} json5_index;
+
+/**
+ * Check if a JSON string is syntactically valid
+ *
+ * Performs the same checks as `json5_coder_decode`, including the validity of
+ * UTF-8 sequences and escape sequences, but does not copy strings, convert
+ * numbers or build values. A string is valid exactly if it can be decoded.
+ *
+ * @param string The string to validate.
+ * @param size The string size in bytes.
+ * @param out_error Set to the first error if the string is invalid. Can be
+ * `NULL`.
+ *
+ * @return 0 if the string is valid otherwise -1.
+ */
+extern int json5_validate (uint8_t const * string, size_t size, json5_validate_error * out_error);
+
+/**
+ * Check if a JSON string is syntactically valid and record the position of
+ * every value and key
+ *
+ * Works like `json5_validate`. @p index is cleared before and its node
+ * memory is reused.
+ *
+ * @return 0 if the string is valid otherwise -1.
+ */
+extern int json5_validate_index (uint8_t const * string, size_t size, json5_index * index, json5_validate_error * out_error);
+
+/**
+ * Free the memory of an index.
+ */
+extern void json5_index_destroy (json5_index * index);
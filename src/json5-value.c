@@ -21,34 +21,371 @@
  * IN THE SOFTWARE.
  */
 
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include "json5-hash.h"
 #include "json5-value.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define ARRAY_MIN_CAP 8
-#define OBJECT_MIN_CAP 8
-#define PLACEHOLDER_KEY ((uint8_t *) 1)
+#define OBJECT_MIN_CAP 2
+#define OBJECT_SMALL_CAP 8
+#define OBJECT_MIN_INDEX 16
+#define OBJECT_INCREMENTAL_INDEX (1 << 16)
+#define OBJECT_MIGRATE_STEP 64
+#define KEY_TABLE_MIN_CAP 64
+#define KEY_TABLE_MAX_LEN 4096
+#define GROUP_WIDTH 16
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define INDEX_KEYSET SIZE_MAX
+#define KEYSET_EMPTY UINT8_MAX
+#define KEYSET_MAX_DISP (1 << 20)
+#define PATH_MIN_CAP 4
+#define NOT_FOUND ((size_t) -1)
 
 static json5_hash hash_table_seed = 0XD4244CD25E94BDBBULL;
+static json5_hash_func hash_table_func = JSON5_HASH_FAST;
+
+/**
+ * Defines the header in front of allocated strings, items and properties.
+ * Aligned for any value stored in the block.
+ */
+typedef union {
+	size_t cap;
+	int64_t ival;
+	double fval;
+	void * ptr;
+} json5_block;
 
-static uint8_t * string_copy (uint8_t const * str, size_t len) {
-	uint8_t * new_str = malloc (len + 1);
+/**
+ * Resize block @p ptr to @p size bytes and set its capacity to @p cap.
+ */
+static void * json5_block_resize (void * ptr, size_t size, size_t cap) {
+	json5_block * block = ptr ? (json5_block *) ptr - 1 : NULL;
 
-	if (!new_str) {
+	if (size > SIZE_MAX - sizeof (*block)) {
 		return NULL;
 	}
 
-	memcpy (new_str, str, len);
-	new_str [len] = '\0';
+	if (!(block = realloc (block, sizeof (*block) + size))) {
+		return NULL;
+	}
+
+	block -> cap = cap;
+
+	return block + 1;
+}
+
+/**
+ * Get capacity of block @p ptr.
+ */
+static size_t json5_block_cap (void const * ptr) {
+	return ptr ? ((json5_block const *) ptr - 1) -> cap : 0;
+}
+
+static void json5_block_free (void * ptr) {
+	if (ptr) {
+		free ((json5_block *) ptr - 1);
+	}
+}
+
+/**
+ * Defines the header in front of object properties.
+ *
+ * Properties are stored in insertion order. Objects with up to
+ * `OBJECT_SMALL_CAP` properties have no index and are searched linearly.
+ * Larger objects are followed by an index table with `index_cap` slots of 8,
+ * 16, 32 or 64 bits depending on its size, each containing a property index,
+ * and by one control byte per slot. A control byte is `CTRL_EMPTY`,
+ * `CTRL_DELETED` or the low 7 bits of the hash of the property in the slot.
+ * The first `GROUP_WIDTH` control bytes are repeated at the end, so a group
+ * can be loaded from any slot. Deleted properties of indexed objects have
+ * their key set to `NULL` and are removed when the table runs full.
+ *
+ */
+typedef struct {
+	size_t cap;       ///< Property capacity.
+	size_t used;      ///< Number of used properties including deleted ones.
+	size_t index_cap; ///< Number of index slots. A power of 2 or 0.
+} json5_object_header;
+
+/**
+ * Defines the state of a growing table. Tables with at least
+ * `OBJECT_INCREMENTAL_INDEX` index slots store it after the control bytes.
+ *
+ * The previous table is kept in `old` and each insertion moves the next
+ * `OBJECT_MIGRATE_STEP` properties to the same position in the new table.
+ * Properties from `moved` up to the number of used properties of `old` are
+ * still stored in `old`.
+ */
+typedef struct {
+	json5_object_header * old; ///< The table being moved or `NULL`.
+	size_t moved;              ///< Number of properties moved from `old`.
+} json5_object_migration;
+
+static inline json5_object_header * json5_object_get_header (json5_obj_prop * props) {
+	return (json5_object_header *) props - 1;
+}
+
+static inline json5_obj_prop * json5_object_get_props (json5_object_header * header) {
+	return (json5_obj_prop *) (header + 1);
+}
+
+static inline void * json5_object_get_index (json5_object_header * header) {
+	return (json5_obj_prop *) (header + 1) + header -> cap;
+}
+
+/**
+ * Get size of an index slot in bytes.
+ */
+static inline size_t json5_index_width (size_t index_cap) {
+	if (index_cap - 1 <= UINT8_MAX) {
+		return sizeof (uint8_t);
+	}
+	else if (index_cap - 1 <= UINT16_MAX) {
+		return sizeof (uint16_t);
+	}
+	else if (index_cap - 1 <= UINT32_MAX) {
+		return sizeof (uint32_t);
+	}
+
+	return sizeof (uint64_t);
+}
+
+static inline uint8_t * json5_object_get_ctrl (json5_object_header * header) {
+	return (uint8_t *) json5_object_get_index (header) + header -> index_cap * json5_index_width (header -> index_cap);
+}
+
+static inline json5_object_migration * json5_object_get_migration (json5_object_header * header) {
+	return (json5_object_migration *) (json5_object_get_ctrl (header) + header -> index_cap + GROUP_WIDTH);
+}
+
+/**
+ * Get the table being moved or `NULL`.
+ */
+static inline json5_object_header * json5_object_get_old (json5_object_header * header) {
+	if (header -> index_cap < OBJECT_INCREMENTAL_INDEX || header -> index_cap == INDEX_KEYSET) {
+		return NULL;
+	}
+
+	return json5_object_get_migration (header) -> old;
+}
+
+/**
+ * Defines the header in front of the values of an object using a key set.
+ *
+ * The value of the key with ID `i` is stored at index `i` of the value array
+ * if bit `i` of `present` is set. The object header is placed directly in
+ * front of the values, so `props` of such objects points to the value array.
+ */
+typedef struct {
+	json5_keyset const * keyset; ///< The key set.
+	uint64_t present;            ///< The IDs of the contained keys.
+	json5_object_header header;  ///< Has `INDEX_KEYSET` as `index_cap`.
+} json5_keyset_header;
+
+static inline int json5_object_is_keyset (json5_object_header const * header) {
+	return header -> index_cap == INDEX_KEYSET;
+}
+
+static inline json5_keyset_header * json5_object_get_keyset (json5_object_header * header) {
+	return (json5_keyset_header *) ((uint8_t *) header - offsetof (json5_keyset_header, header));
+}
+
+static inline json5_value * json5_object_get_values (json5_obj_prop * props) {
+	return (json5_value *) props;
+}
+
+/**
+ * Get property at @p idx, which may still be stored in the table being moved.
+ */
+static inline json5_obj_prop * json5_object_get_prop (json5_obj_prop * props, size_t idx) {
+	json5_object_header * header = json5_object_get_header (props);
+	json5_object_header * old = json5_object_get_old (header);
+
+	if (old && idx >= json5_object_get_migration (header) -> moved && idx < old -> used) {
+		return &json5_object_get_props (old) [idx];
+	}
+
+	return &props [idx];
+}
+
+
+static inline size_t json5_index_get (void const * index, size_t width, size_t slot) {
+	switch (width) {
+		case sizeof (uint8_t): {
+			return ((uint8_t const *) index) [slot];
+			break;
+		}
+		case sizeof (uint16_t): {
+			return ((uint16_t const *) index) [slot];
+			break;
+		}
+		case sizeof (uint32_t): {
+			return ((uint32_t const *) index) [slot];
+			break;
+		}
+		default: {
+			return ((uint64_t const *) index) [slot];
+			break;
+		}
+	}
+}
+
+static inline void json5_index_set (void * index, size_t width, size_t slot, size_t ix) {
+	switch (width) {
+		case sizeof (uint8_t): {
+			((uint8_t *) index) [slot] = ix;
+			break;
+		}
+		case sizeof (uint16_t): {
+			((uint16_t *) index) [slot] = ix;
+			break;
+		}
+		case sizeof (uint32_t): {
+			((uint32_t *) index) [slot] = ix;
+			break;
+		}
+		default: {
+			((uint64_t *) index) [slot] = ix;
+			break;
+		}
+	}
+}
+
+/**
+ * Set control byte of @p slot and its copy at the end.
+ */
+static inline void json5_ctrl_set (uint8_t * ctrl, size_t index_cap, size_t slot, uint8_t tag) {
+	ctrl [slot] = tag;
+
+	if (slot < GROUP_WIDTH) {
+		ctrl [index_cap + slot] = tag;
+	}
+}
+
+/**
+ * Get bit mask of the control bytes in the group at @p ctrl equal to @p tag.
+ */
+static inline unsigned json5_group_match (uint8_t const * ctrl, uint8_t tag) {
+#ifdef __SSE2__
+	__m128i group = _mm_loadu_si128 ((__m128i const *) ctrl);
+
+	return (unsigned) _mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 ((char) tag)));
+#else
+	unsigned mask = 0;
+
+	for (unsigned i = 0; i < GROUP_WIDTH; i ++) {
+		mask |= (unsigned) (ctrl [i] == tag) << i;
+	}
+
+	return mask;
+#endif
+}
+
+/**
+ * Get bit mask of the empty or deleted control bytes in the group at @p ctrl.
+ */
+static inline unsigned json5_group_match_free (uint8_t const * ctrl) {
+#ifdef __SSE2__
+	return (unsigned) _mm_movemask_epi8 (_mm_loadu_si128 ((__m128i const *) ctrl));
+#else
+	unsigned mask = 0;
+
+	for (unsigned i = 0; i < GROUP_WIDTH; i ++) {
+		mask |= (unsigned) (ctrl [i] >> 7) << i;
+	}
+
+	return mask;
+#endif
+}
+
+/**
+ * Get index of the lowest set bit in @p mask. @p mask must not be 0.
+ */
+static inline unsigned json5_group_first (unsigned mask) {
+#ifdef __GNUC__
+	return (unsigned) __builtin_ctz (mask);
+#else
+	unsigned i = 0;
+
+	while (!(mask & 1)) {
+		mask >>= 1;
+		i ++;
+	}
+
+	return i;
+#endif
+}
+
+/**
+ * Defines the header in front of object keys. Keys are immutable and can be
+ * shared by multiple properties.
+ */
+typedef struct {
+	atomic_size_t refs;
+	json5_hash hash;
+	size_t len;
+} json5_key_header;
+
+/**
+ * Create key with a single reference.
+ */
+static uint8_t * json5_key_create (uint8_t const * chars, size_t len, json5_hash hash) {
+	json5_key_header * key;
+	uint8_t * new_chars;
 
-	return new_str;
+	if (len > SIZE_MAX - sizeof (*key) - 1) {
+		return NULL;
+	}
+
+	if (!(key = malloc (sizeof (*key) + len + 1))) {
+		return NULL;
+	}
+
+	atomic_init (&key -> refs, 1);
+	key -> hash = hash;
+	key -> len = len;
+
+	new_chars = (uint8_t *) (key + 1);
+	memcpy (new_chars, chars, len);
+	new_chars [len] = '\0';
+
+	return new_chars;
+}
+
+static uint8_t * json5_key_retain (uint8_t * chars) {
+	json5_key_header * key = (json5_key_header *) chars - 1;
+
+	atomic_fetch_add_explicit (&key -> refs, 1, memory_order_relaxed);
+
+	return chars;
+}
+
+/**
+ * Release key and free it if it has no references left.
+ */
+static void json5_key_release (uint8_t * chars) {
+	json5_key_header * key = (json5_key_header *) chars - 1;
+
+	if (atomic_fetch_sub_explicit (&key -> refs, 1, memory_order_acq_rel) == 1) {
+		free (key);
+	}
 }
 
 /**
  * Delete string `value`.
  */
 static void json5_value_delete_string (json5_value * value) {
-	free (value -> sval);
+	if (value -> len >= sizeof (value -> chars)) {
+		json5_block_free (value -> sval);
+	}
 }
 
 /**
@@ -59,24 +396,47 @@ static void json5_value_delete_array (json5_value * value) {
 		json5_value_set_null (&value -> items [i]);
 	}
 
-	free (value -> items);
+	json5_block_free (value -> items);
 }
 
 /**
  * Delete key-value pairs object object `value`.
  */
 static void json5_value_delete_object (json5_value * value) {
+	json5_object_header * header;
 	json5_obj_prop * prop;
 
-	for (size_t i = 0; i < value -> cap; i ++) {
-		prop = &value -> props [i];
+	if (!value -> props) {
+		return;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		json5_keyset_header * keyset = json5_object_get_keyset (header);
+
+		for (size_t i = 0; i < header -> used; i ++) {
+			if (keyset -> present & ((uint64_t) 1 << i)) {
+				json5_value_set_null (&json5_object_get_values (value -> props) [i]);
+			}
+		}
+
+		free (keyset);
+
+		return;
+	}
+
+	for (size_t i = 0; i < header -> used; i ++) {
+		prop = json5_object_get_prop (value -> props, i);
 
-		if (prop -> key > PLACEHOLDER_KEY) {
+		if (prop -> key) {
 			json5_value_set_null (&prop -> value);
+			json5_key_release (prop -> key);
 		}
 	}
 
-	free (value -> props);
+	free (json5_object_get_old (header));
+	free (header);
 }
 
 /**
@@ -110,7 +470,7 @@ void json5_value_reset (json5_value * value, json5_type type) {
 }
 
 int json5_value_set_string (json5_value * value, char const * str, size_t len) {
-	uint8_t * new_str;
+	uint8_t * new_str = NULL;
 
 	if (value -> type != JSON5_TYPE_STRING) {
 		if (value -> type >= JSON5_TYPE_STRING) {
@@ -120,23 +480,35 @@ int json5_value_set_string (json5_value * value, char const * str, size_t len) {
 			value -> type = JSON5_TYPE_STRING;
 		}
 
-		value -> sval = NULL;
+		value -> len = 0;
 	}
 
 	if (len == (size_t) -1) {
 		len = strlen (str);
 	}
 
-	new_str = value -> sval;
+	if (len > JSON5_VALUE_MAX_LEN) {
+		return -1;
+	}
+
+	if (value -> len >= sizeof (value -> chars)) {
+		new_str = value -> sval;
+	}
 
-	if (len > value -> cap) {
-		new_str = realloc (new_str, len + 1);
+	// store short strings inline
+	if (len < sizeof (value -> chars)) {
+		memmove (value -> chars, str, len);
+		value -> chars [len] = '\0';
+		value -> len = len;
+		json5_block_free (new_str);
 
-		if (!new_str) {
+		return 0;
+	}
+
+	if (len > json5_block_cap (new_str)) {
+		if (!(new_str = json5_block_resize (new_str, len + 1, len))) {
 			return -1;
 		}
-
-		value -> cap = len;
 	}
 
 	memcpy (new_str, str, len);
@@ -162,23 +534,24 @@ json5_value * json5_value_get_item (json5_value * value, size_t idx) {
 
 json5_value * json5_value_append_item (json5_value * value) {
 	json5_value * item;
-	json5_value * new_items;
-	size_t new_cap;
+	size_t cap;
 
 	if (value -> type != JSON5_TYPE_ARRAY) {
 		return NULL;
 	}
 
-	if (value -> len >= value -> cap) {
-		new_cap = value -> cap ? value -> cap * 2 : ARRAY_MIN_CAP;
-		new_items = realloc (value -> items, new_cap * sizeof (*item));
+	cap = json5_block_cap (value -> items);
 
-		if (!new_items) {
-			return NULL;
+	if (value -> len >= cap) {
+		cap = cap ? cap * 2 : ARRAY_MIN_CAP;
+
+		if (cap > JSON5_VALUE_MAX_LEN) {
+			cap = JSON5_VALUE_MAX_LEN;
 		}
 
-		value -> cap = new_cap;
-		value -> items = new_items;
+		if (value -> len >= cap || json5_value_reserve (value, cap) != 0) {
+			return NULL;
+		}
 	}
 
 	item = &value -> items [value -> len ++];
@@ -187,171 +560,1131 @@ json5_value * json5_value_append_item (json5_value * value) {
 	return item;
 }
 
-static json5_hash json5_get_hash (char const * key, size_t key_len) {
-	json5_hash hash = hash_table_seed;
+int json5_value_reserve (json5_value * value, size_t cap) {
+	json5_value * new_items;
 
-	for (size_t i = 0; i < key_len; i ++) {
-		hash = (hash * 100003) ^ key [i];
+	if (value -> type != JSON5_TYPE_ARRAY) {
+		return -1;
 	}
 
-	return hash;
-}
+	if (cap > JSON5_VALUE_MAX_LEN || cap > SIZE_MAX / sizeof (*new_items)) {
+		return -1;
+	}
 
-static json5_obj_prop * json5_prop_lookup (json5_obj_prop * props, size_t cap, json5_hash hash, uint8_t const * key, size_t key_len) {
-	json5_hash i = hash, perturb = hash;
-	size_t mask = cap - 1;
-	json5_obj_prop * prop = &props [i & mask];
+	if (cap > json5_block_cap (value -> items)) {
+		new_items = json5_block_resize (value -> items, cap * sizeof (*new_items), cap);
 
-	while (prop -> key) {
-		if (prop -> hash == hash) {
-			if (prop -> key != PLACEHOLDER_KEY && memcmp (prop -> key, key, key_len) == 0) {
-				break;
-			}
+		if (!new_items) {
+			return -1;
 		}
 
-		i += (perturb >>= 5) + 1;
-		prop = &props [i & mask];
+		value -> items = new_items;
 	}
 
-	return prop;
+	return 0;
 }
 
-json5_value * json5_value_get_prop (json5_value * value, char const * key, size_t key_len) {
-	json5_hash hash;
-	json5_obj_prop * prop;
-
-	if (value -> type != JSON5_TYPE_OBJECT) {
-		return NULL;
-	}
-
-	if (!value -> cap) {
-		return NULL;
-	}
-
+json5_hash json5_hash_key (char const * key, size_t key_len) {
 	if (key_len == (size_t) -1) {
 		key_len = strlen (key);
 	}
 
-	hash = json5_get_hash (key, key_len);
-	prop = json5_prop_lookup (value -> props, value -> cap, hash, (uint8_t const *) key, key_len);
-
-	if (prop -> key > PLACEHOLDER_KEY) {
-		return &prop -> value;
+	if (hash_table_func == JSON5_HASH_SIP) {
+		return json5_hash_sip (key, key_len, hash_table_seed);
 	}
 
-	return NULL;
+	return json5_hash_fast (key, key_len, hash_table_seed);
 }
 
-static int json5_object_grow (json5_value * value) {
-	size_t new_cap = value -> cap * 2;
-	json5_obj_prop * prop, * new_prop, * new_props;
+/**
+ * Mix @p hash with a seed depending on the table capacity. Tables of
+ * different sizes probe in a different order, so inserting the properties of
+ * one table into another does not cluster.
+ */
+static inline json5_hash json5_table_hash (json5_hash hash, size_t cap) {
+	return json5_hash_mix (hash ^ hash_table_seed, (cap * 0x9E3779B97F4A7C15ULL) | 1);
+}
+
+/**
+ * Find property with @p key in an object without index and return its index
+ * or `NOT_FOUND`.
+ */
+static size_t json5_object_scan (json5_obj_prop * props, uint8_t const * key, size_t key_len) {
+	json5_obj_prop const * prop = props;
+	json5_obj_prop const * end = &props [json5_object_get_header (props) -> used];
+
+	for (; prop < end; prop ++) {
+		// interned keys are equal if they are the same
+		if (prop -> key == key) {
+			return prop - props;
+		}
 
-	if (new_cap < OBJECT_MIN_CAP) {
-		new_cap = OBJECT_MIN_CAP;
+		if (prop -> key_len == key_len && (!key_len || prop -> key [0] == key [0]) && memcmp (prop -> key, key, key_len) == 0) {
+			return prop - props;
+		}
 	}
 
-	new_props = calloc (new_cap, sizeof (*new_props));
+	return NOT_FOUND;
+}
 
-	if (!new_props) {
-		return -1;
-	}
+/**
+ * Find property with @p key in an object with index and return its index or
+ * `NOT_FOUND`. Sets @p out_slot to the index slot of the property or to the
+ * slot where it can be inserted. Properties before @p first are ignored.
+ *
+ * Groups of `GROUP_WIDTH` control bytes are compared at once with the 7-bit
+ * tag of the hash. Only slots with matching tags are compared with the key.
+ * The search ends at the first group containing an empty slot.
+ */
+static size_t json5_object_find_from (json5_obj_prop * props, size_t first, json5_hash hash, uint8_t const * key, size_t key_len, size_t * out_slot) {
+	json5_object_header * header = json5_object_get_header (props);
+	void const * index = json5_object_get_index (header);
+	uint8_t const * ctrl = json5_object_get_ctrl (header);
+	size_t width = json5_index_width (header -> index_cap);
+	size_t mask = header -> index_cap - 1;
+	size_t free_slot = NOT_FOUND;
+	json5_hash table_hash = json5_table_hash (hash, header -> index_cap);
+	uint8_t tag = table_hash & 0x7F;
+	size_t pos = (table_hash >> 7) & mask;
+	size_t stride = 0;
+	json5_obj_prop const * prop;
+	unsigned bits;
+	size_t slot, ix;
+
+	for (;;) {
+		bits = json5_group_match (&ctrl [pos], tag);
+
+		while (bits) {
+			slot = (pos + json5_group_first (bits)) & mask;
+			ix = json5_index_get (index, width, slot);
+			prop = &props [ix];
+
+			if (ix >= first && (prop -> key == key || (prop -> hash == hash && prop -> key_len == key_len && memcmp (prop -> key, key, key_len) == 0))) {
+				*out_slot = slot;
+
+				return ix;
+			}
 
-	for (size_t i = 0; i < value -> cap; i ++) {
-		prop = &value -> props [i];
+			bits &= bits - 1;
+		}
+
+		if (free_slot == NOT_FOUND && (bits = json5_group_match_free (&ctrl [pos]))) {
+			free_slot = (pos + json5_group_first (bits)) & mask;
+		}
 
-		if (prop -> key > PLACEHOLDER_KEY) {
-			new_prop = json5_prop_lookup (new_props, new_cap - 1, prop -> hash, prop -> key, prop -> key_len);
-			*new_prop = *prop;
+		if (json5_group_match (&ctrl [pos], CTRL_EMPTY)) {
+			break;
 		}
+
+		// visits each group once as the number of groups is a power of 2
+		stride += GROUP_WIDTH;
+		pos = (pos + stride) & mask;
 	}
 
-	free (value -> props);
+	*out_slot = free_slot;
 
-	value -> cap = new_cap;
-	value -> props = new_props;
+	return NOT_FOUND;
+}
 
-	return 0;
+static inline size_t json5_object_find (json5_obj_prop * props, json5_hash hash, uint8_t const * key, size_t key_len, size_t * out_slot) {
+	return json5_object_find_from (props, 0, hash, key, key_len, out_slot);
 }
 
-json5_value * json5_value_set_prop (json5_value * value, char const * key, size_t key_len, int replace) {
-	json5_hash hash;
-	json5_obj_prop * prop;
-	uint8_t * new_key;
+/**
+ * Set index @p slot to property @p ix with @p hash.
+ */
+static void json5_object_set_slot (json5_object_header * header, size_t slot, json5_hash hash, size_t ix) {
+	uint8_t tag = json5_table_hash (hash, header -> index_cap) & 0x7F;
 
-	if (value -> type != JSON5_TYPE_OBJECT) {
-		return NULL;
-	}
+	json5_index_set (json5_object_get_index (header), json5_index_width (header -> index_cap), slot, ix);
+	json5_ctrl_set (json5_object_get_ctrl (header), header -> index_cap, slot, tag);
+}
 
-	if (!value -> cap) {
-		if (json5_object_grow (value) != 0) {
-			return NULL;
-		}
+/**
+ * Add property @p ix to the index. The property must not be in the index.
+ */
+static void json5_object_index_add (json5_object_header * header, size_t ix) {
+	json5_obj_prop const * prop = &json5_object_get_props (header) [ix];
+	uint8_t const * ctrl = json5_object_get_ctrl (header);
+	size_t mask = header -> index_cap - 1;
+	size_t pos = (json5_table_hash (prop -> hash, header -> index_cap) >> 7) & mask;
+	size_t stride = 0;
+	unsigned bits;
+
+	while (!(bits = json5_group_match_free (&ctrl [pos]))) {
+		stride += GROUP_WIDTH;
+		pos = (pos + stride) & mask;
 	}
 
-	if (key_len == (size_t) -1) {
-		key_len = strlen (key);
+	json5_object_set_slot (header, (pos + json5_group_first (bits)) & mask, prop -> hash, ix);
+}
+
+/**
+ * Clear the index and insert all properties. The properties must not
+ * contain deleted ones.
+ */
+static void json5_object_build_index (json5_object_header * header) {
+	memset (json5_object_get_ctrl (header), CTRL_EMPTY, header -> index_cap + GROUP_WIDTH);
+
+	for (size_t i = 0; i < header -> used; i ++) {
+		json5_object_index_add (header, i);
 	}
+}
 
-	hash = json5_get_hash (key, key_len);
-	prop = json5_prop_lookup (value -> props, value -> cap, hash, (uint8_t const *) key, key_len);
+/**
+ * Find property with @p key in the table being moved and return it or `NULL`.
+ * Sets @p out_slot to the index slot of the property in the old table.
+ */
+static json5_obj_prop * json5_object_find_old (json5_object_header * header, json5_hash hash, uint8_t const * key, size_t key_len, size_t * out_slot) {
+	json5_object_migration const * migration = json5_object_get_migration (header);
+	json5_obj_prop * props = json5_object_get_props (migration -> old);
+	size_t idx;
 
-	if (value -> len + (value -> len / 2) > value -> cap) {
-		if (json5_object_grow (value) != 0) {
-			return NULL;
-		}
+	// moved properties are found in the new table and their keys may
+	// already be released
+	idx = json5_object_find_from (props, migration -> moved, hash, key, key_len, out_slot);
 
-		prop = json5_prop_lookup (value -> props, value -> cap, hash, (uint8_t const *)key, key_len);
+	if (idx == NOT_FOUND) {
+		return NULL;
 	}
 
-	if (prop->key > PLACEHOLDER_KEY && !replace) {
+	return &props [idx];
+}
+
+/**
+ * Move up to @p count properties from the old table and free it when all
+ * properties are moved.
+ */
+static void json5_object_migrate (json5_object_header * header, size_t count) {
+	json5_object_migration * migration = json5_object_get_migration (header);
+	json5_object_header * old = migration -> old;
+	json5_obj_prop * props = json5_object_get_props (header);
+	json5_obj_prop const * old_props = json5_object_get_props (old);
+	size_t end = old -> used - migration -> moved > count ? migration -> moved + count : old -> used;
+
+	for (size_t i = migration -> moved; i < end; i ++) {
+		// deleted properties are kept as holes
+		props [i] = old_props [i];
+
+		if (props [i].key) {
+			json5_object_index_add (header, i);
+		}
+	}
+
+	migration -> moved = end;
+
+	if (end == old -> used) {
+		free (old);
+		migration -> old = NULL;
+		migration -> moved = 0;
+	}
+}
+
+/**
+ * Get slot of a key with @p hash in a key set with bucket displacement
+ * @p disp.
+ */
+static inline size_t json5_keyset_slot (json5_hash hash, uint32_t disp, size_t slot_mask) {
+	return json5_hash_mix (hash, ((json5_hash) disp + 1) * 0x9E3779B97F4A7C15ULL) & slot_mask;
+}
+
+static inline size_t json5_keyset_bucket (json5_hash hash, size_t bucket_mask) {
+	return (hash >> 32) & bucket_mask;
+}
+
+/**
+ * Get ID of @p key in @p keyset or `NOT_FOUND`. The key hash is only computed
+ * if @p hash is `NULL`.
+ */
+static size_t json5_keyset_lookup (json5_keyset const * keyset, uint8_t const * key, size_t key_len, json5_hash const * hash) {
+	json5_key const * entry;
+	json5_hash key_hash;
+	size_t id;
+
+	if (!keyset -> len) {
+		return NOT_FOUND;
+	}
+
+	// the hash function is only valid for the seed it was built with
+	if (keyset -> seed != hash_table_seed || keyset -> func != hash_table_func) {
+		for (id = 0; id < keyset -> len; id ++) {
+			entry = &keyset -> keys [id];
+
+			if (entry -> key_len == key_len && memcmp (entry -> key, key, key_len) == 0) {
+				return id;
+			}
+		}
+
+		return NOT_FOUND;
+	}
+
+	key_hash = hash ? *hash : json5_hash_key ((char const *) key, key_len);
+	id = keyset -> ids [json5_keyset_slot (key_hash, keyset -> disps [json5_keyset_bucket (key_hash, keyset -> bucket_mask)], keyset -> slot_mask)];
+
+	if (id == KEYSET_EMPTY) {
+		return NOT_FOUND;
+	}
+
+	entry = &keyset -> keys [id];
+
+	if ((uint8_t const *) entry -> key == key || (entry -> key_len == key_len && memcmp (entry -> key, key, key_len) == 0)) {
+		return id;
+	}
+
+	return NOT_FOUND;
+}
+
+/**
+ * Get property value with @p key. The key hash is only computed if the object
+ * has an index or a key set and @p hash is `NULL`.
+ */
+static json5_value * json5_object_get (json5_value * value, uint8_t const * key, size_t key_len, json5_hash const * hash) {
+	json5_object_header * header;
+	json5_keyset_header * keyset;
+	json5_obj_prop * prop;
+	json5_hash key_hash;
+	size_t idx, slot;
+
+	if (!value -> props) {
+		return NULL;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		keyset = json5_object_get_keyset (header);
+		idx = json5_keyset_lookup (keyset -> keyset, key, key_len, hash);
+
+		if (idx == NOT_FOUND || !(keyset -> present & ((uint64_t) 1 << idx))) {
+			return NULL;
+		}
+
+		return &json5_object_get_values (value -> props) [idx];
+	}
+
+	if (!header -> index_cap) {
+		idx = json5_object_scan (value -> props, key, key_len);
+	}
+	else {
+		key_hash = hash ? *hash : json5_hash_key ((char const *) key, key_len);
+		idx = json5_object_find (value -> props, key_hash, key, key_len, &slot);
+
+		// lookups do not move properties
+		if (idx == NOT_FOUND && json5_object_get_old (header)) {
+			prop = json5_object_find_old (header, key_hash, key, key_len, &slot);
+
+			return prop ? &prop -> value : NULL;
+		}
+	}
+
+	if (idx != NOT_FOUND) {
+		return &value -> props [idx].value;
+	}
+
+	return NULL;
+}
+
+json5_value * json5_value_get_prop (json5_value * value, char const * key, size_t key_len) {
+	if (value -> type != JSON5_TYPE_OBJECT) {
+		return NULL;
+	}
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	return json5_object_get (value, (uint8_t const *) key, key_len, NULL);
+}
+
+/**
+ * Move properties to a new table with at least @p min_cap properties and drop
+ * deleted properties. Tables with more than `OBJECT_SMALL_CAP` properties
+ * get an index. Properties of large tables are moved incrementally.
+ * The old table must not be moving.
+ */
+static int json5_object_resize (json5_value * value, size_t min_cap) {
+	json5_object_header * header, * old_header = NULL;
+	json5_obj_prop * prop, * props;
+	size_t cap = OBJECT_MIN_CAP;
+	size_t index_cap = 0;
+	size_t index_size = 0;
+	size_t used = 0;
+	json5_object_migration * migration = NULL;
+
+	if (min_cap > OBJECT_SMALL_CAP) {
+		index_cap = OBJECT_MIN_INDEX;
+
+		// keep the index at most 2/3 full
+		while (index_cap / 3 * 2 < min_cap) {
+			if (index_cap > SIZE_MAX / 2) {
+				return -1;
+			}
+
+			index_cap *= 2;
+		}
+
+		cap = index_cap / 3 * 2;
+	}
+	else {
+		while (cap < min_cap) {
+			cap *= 2;
+		}
+	}
+
+	// cap <= index_cap if the object has an index
+	if ((index_cap ? index_cap : cap) > (SIZE_MAX - sizeof (*header) - GROUP_WIDTH - sizeof (*migration)) / (sizeof (*props) + sizeof (uint64_t) + 1)) {
+		return -1;
+	}
+
+	if (index_cap) {
+		index_size = index_cap * json5_index_width (index_cap) + index_cap + GROUP_WIDTH;
+	}
+
+	if (index_cap >= OBJECT_INCREMENTAL_INDEX) {
+		index_size += sizeof (*migration);
+	}
+
+	if (!(header = malloc (sizeof (*header) + cap * sizeof (*props) + index_size))) {
+		return -1;
+	}
+
+	header -> cap = cap;
+	header -> index_cap = index_cap;
+	props = (json5_obj_prop *) (header + 1);
+
+	if (index_cap >= OBJECT_INCREMENTAL_INDEX) {
+		migration = json5_object_get_migration (header);
+		migration -> old = NULL;
+		migration -> moved = 0;
+	}
+
+	if (value -> props) {
+		old_header = json5_object_get_header (value -> props);
+
+		// keep deleted properties to move properties to the same position
+		if (migration && old_header -> index_cap && old_header -> used <= cap) {
+			memset (json5_object_get_ctrl (header), CTRL_EMPTY, index_cap + GROUP_WIDTH);
+
+			header -> used = old_header -> used;
+			migration -> old = old_header;
+			value -> props = props;
+
+			return 0;
+		}
+	}
+
+	for (size_t j = 0; old_header && j < old_header -> used; j ++) {
+		prop = &value -> props [j];
+
+		if (!prop -> key) {
+			continue;
+		}
+
+		props [used] = *prop;
+
+		// properties of objects without index are not hashed yet
+		if (index_cap && !old_header -> index_cap) {
+			props [used].hash = json5_hash_key ((char const *) prop -> key, prop -> key_len);
+		}
+
+		used ++;
+	}
+
+	free (old_header);
+
+	header -> used = used;
+	value -> props = props;
+
+	if (index_cap) {
+		json5_object_build_index (header);
+	}
+
+	return 0;
+}
+
+/**
+ * Remove deleted properties of an object with index and rebuild the index
+ * without reallocating the table.
+ */
+static void json5_object_rehash (json5_value * value) {
+	json5_object_header * header = json5_object_get_header (value -> props);
+	json5_obj_prop * props = value -> props;
+	size_t used = 0;
+
+	for (size_t j = 0; j < header -> used; j ++) {
+		if (props [j].key) {
+			props [used ++] = props [j];
+		}
+	}
+
+	header -> used = used;
+	json5_object_build_index (header);
+}
+
+/**
+ * Make room for a new property. Tables with index are rehashed in place if
+ * at least a quarter of the properties are deleted.
+ */
+static int json5_object_grow (json5_value * value) {
+	json5_object_header * header;
+
+	if (value -> props) {
+		header = json5_object_get_header (value -> props);
+
+		if (json5_object_get_old (header)) {
+			json5_object_migrate (header, SIZE_MAX);
+		}
+
+		if (header -> index_cap && value -> len <= header -> cap - header -> cap / 4) {
+			json5_object_rehash (value);
+
+			return 0;
+		}
+	}
+
+	return json5_object_resize (value, (size_t) value -> len * 2);
+}
+
+/**
+ * Move the values of an object using a key set to a property table. The
+ * properties share the keys of the key set.
+ */
+static int json5_object_from_keyset (json5_value * value) {
+	json5_keyset_header * keyset = json5_object_get_keyset (json5_object_get_header (value -> props));
+	json5_value * values = json5_object_get_values (value -> props);
+	json5_object_header * header;
+	json5_obj_prop * prop;
+	json5_key const * key;
+
+	value -> props = NULL;
+
+	if (json5_object_resize (value, value -> len) != 0) {
+		value -> props = (json5_obj_prop *) values;
+
+		return -1;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	for (size_t id = 0; id < keyset -> header.used; id ++) {
+		if (keyset -> present & ((uint64_t) 1 << id)) {
+			key = &keyset -> keyset -> keys [id];
+			prop = &value -> props [header -> used ++];
+			prop -> hash = json5_hash_key (key -> key, key -> key_len);
+			prop -> key = json5_key_retain ((uint8_t *) (uintptr_t) key -> key);
+			prop -> key_len = key -> key_len;
+			prop -> value = values [id];
+		}
+	}
+
+	if (header -> index_cap) {
+		json5_object_build_index (header);
+	}
+
+	free (keyset);
+
+	return 0;
+}
+
+/**
+ * Get or add the value of @p key if @p value uses a key set containing
+ * @p key. Returns `NULL` otherwise.
+ */
+static json5_value * json5_object_keyset_value (json5_value * value, uint8_t const * key, size_t key_len, uint8_t const ** out_key, int * out_exists) {
+	json5_keyset_header * keyset;
+	json5_value * values;
+	size_t id;
+
+	if (!value -> props || !json5_object_is_keyset (json5_object_get_header (value -> props))) {
+		return NULL;
+	}
+
+	keyset = json5_object_get_keyset (json5_object_get_header (value -> props));
+	id = json5_keyset_lookup (keyset -> keyset, key, key_len, NULL);
+
+	if (id == NOT_FOUND) {
+		return NULL;
+	}
+
+	values = json5_object_get_values (value -> props);
+	*out_key = (uint8_t const *) keyset -> keyset -> keys [id].key;
+	*out_exists = (keyset -> present >> id) & 1;
+
+	if (!*out_exists) {
+		keyset -> present |= (uint64_t) 1 << id;
+		values [id] = JSON5_VALUE_INIT;
+		value -> len ++;
+	}
+
+	return &values [id];
+}
+
+json5_value * json5_value_set_prop (json5_value * value, char const * key, size_t key_len, int replace) {
+	int exists;
+	json5_obj_prop * prop;
+	json5_value * item = NULL;
+	uint8_t const * item_key;
+
+	if (value -> type == JSON5_TYPE_OBJECT) {
+		if (key_len == (size_t) -1) {
+			key_len = strlen (key);
+		}
+
+		item = json5_object_keyset_value (value, (uint8_t const *) key, key_len, &item_key, &exists);
+	}
+
+	if (!item) {
+		if (!(prop = json5_value_insert_prop (value, key, key_len, &exists))) {
+			return NULL;
+		}
+
+		item = &prop -> value;
+	}
+
+	// keep key storage of replaced property
+	if (exists) {
+		if (!replace) {
+			return NULL;
+		}
+
+		json5_value_set_null (item);
+	}
+
+	return item;
+}
+
+/**
+ * Get or insert property with @p key. The key of a new property is
+ * shared with @p shared_key if given otherwise copied. The key hash is only
+ * computed if the object has an index and @p hash is `NULL`.
+ */
+static json5_obj_prop * json5_object_insert (json5_value * value, uint8_t const * key, size_t key_len, json5_hash const * hash, uint8_t * shared_key, int * out_exists) {
+	json5_object_header * header;
+	json5_obj_prop * prop;
+	json5_hash key_hash = hash ? *hash : 0;
+	uint8_t * new_key;
+	size_t idx, slot = 0, old_slot;
+
+	if (value -> props) {
+		header = json5_object_get_header (value -> props);
+
+		// properties have to be returned
+		if (json5_object_is_keyset (header)) {
+			if (json5_object_from_keyset (value) != 0) {
+				return NULL;
+			}
+
+			header = json5_object_get_header (value -> props);
+		}
+
+		if (json5_object_get_old (header)) {
+			json5_object_migrate (header, OBJECT_MIGRATE_STEP);
+		}
+
+		if (!header -> index_cap) {
+			idx = json5_object_scan (value -> props, key, key_len);
+		}
+		else {
+			if (!hash) {
+				key_hash = json5_hash_key ((char const *) key, key_len);
+				hash = &key_hash;
+			}
+
+			idx = json5_object_find (value -> props, key_hash, key, key_len, &slot);
+
+			if (idx == NOT_FOUND && json5_object_get_old (header) && (prop = json5_object_find_old (header, key_hash, key, key_len, &old_slot))) {
+				*out_exists = 1;
+
+				return prop;
+			}
+		}
+
+		if (idx != NOT_FOUND) {
+			*out_exists = 1;
+
+			return &value -> props [idx];
+		}
+	}
+
+	if (value -> len >= JSON5_VALUE_MAX_LEN) {
+		return NULL;
+	}
+
+	if (!value -> props || json5_object_get_header (value -> props) -> used >= json5_object_get_header (value -> props) -> cap) {
+		if (json5_object_grow (value) != 0) {
+			return NULL;
+		}
+
+		if (json5_object_get_header (value -> props) -> index_cap) {
+			if (!hash) {
+				key_hash = json5_hash_key ((char const *) key, key_len);
+				hash = &key_hash;
+			}
+
+			json5_object_find (value -> props, key_hash, key, key_len, &slot);
+		}
+	}
+
+	if (shared_key) {
+		new_key = json5_key_retain (shared_key);
+	}
+	else if (!(new_key = json5_key_create (key, key_len, key_hash))) {
+		return NULL;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (header -> index_cap) {
+		json5_object_set_slot (header, slot, key_hash, header -> used);
+	}
+
+	prop = &value -> props [header -> used ++];
+	prop -> hash = key_hash;
+	prop -> key = new_key;
+	prop -> key_len = key_len;
+	prop -> value = JSON5_VALUE_INIT;
+	value -> len ++;
+	*out_exists = 0;
+
+	return prop;
+}
+
+json5_obj_prop * json5_value_insert_prop (json5_value * value, char const * key, size_t key_len, int * out_exists) {
+	if (value -> type != JSON5_TYPE_OBJECT) {
+		return NULL;
+	}
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	return json5_object_insert (value, (uint8_t const *) key, key_len, NULL, NULL, out_exists);
+}
+
+static uint8_t ** json5_key_table_lookup (uint8_t ** keys, size_t cap, json5_hash hash, uint8_t const * key, size_t key_len) {
+	size_t mask = cap - 1;
+	size_t i = hash & mask;
+	json5_key_header const * header;
+
+	while (keys [i]) {
+		header = (json5_key_header const *) keys [i] - 1;
+
+		if (header -> hash == hash && header -> len == key_len && memcmp (keys [i], key, key_len) == 0) {
+			break;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return &keys [i];
+}
+
+static int json5_key_table_grow (json5_key_table * table) {
+	uint8_t ** new_keys;
+	json5_key_header const * header;
+	size_t new_cap = table -> cap ? table -> cap * 2 : KEY_TABLE_MIN_CAP;
+
+	if (!(new_keys = calloc (new_cap, sizeof (*new_keys)))) {
+		return -1;
+	}
+
+	for (size_t i = 0; i < table -> cap; i ++) {
+		if (table -> keys [i]) {
+			header = (json5_key_header const *) table -> keys [i] - 1;
+			*json5_key_table_lookup (new_keys, new_cap, header -> hash, table -> keys [i], header -> len) = table -> keys [i];
+		}
+	}
+
+	free (table -> keys);
+
+	table -> keys = new_keys;
+	table -> cap = new_cap;
+
+	return 0;
+}
+
+/**
+ * Get interned key or add it to the table. Returns `NULL` if the table is
+ * full or an allocation error occured.
+ */
+static uint8_t * json5_key_table_intern (json5_key_table * table, uint8_t const * key, size_t key_len, json5_hash hash) {
+	uint8_t ** slot = NULL;
+
+	if (table -> cap) {
+		slot = json5_key_table_lookup (table -> keys, table -> cap, hash, key, key_len);
+
+		if (*slot) {
+			return *slot;
+		}
+	}
+
+	// documents with many distinct keys are not interned any further
+	if (table -> len >= KEY_TABLE_MAX_LEN) {
+		return NULL;
+	}
+
+	if (table -> len * 2 >= table -> cap) {
+		if (json5_key_table_grow (table) != 0) {
+			return NULL;
+		}
+
+		slot = json5_key_table_lookup (table -> keys, table -> cap, hash, key, key_len);
+	}
+
+	if (!(*slot = json5_key_create (key, key_len, hash))) {
+		return NULL;
+	}
+
+	table -> len ++;
+
+	return *slot;
+}
+
+json5_obj_prop * json5_value_intern_prop (json5_value * value, json5_key_table * table, char const * key, size_t key_len, int * out_exists) {
+	json5_hash hash;
+	uint8_t * shared_key;
+
+	if (value -> type != JSON5_TYPE_OBJECT) {
 		return NULL;
 	}
 
-	new_key = string_copy ((uint8_t const *) key, key_len);
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	hash = json5_hash_key (key, key_len);
+
+	if ((shared_key = json5_key_table_intern (table, (uint8_t const *) key, key_len, hash))) {
+		key = (char const *) shared_key;
+	}
+
+	return json5_object_insert (value, (uint8_t const *) key, key_len, &hash, shared_key, out_exists);
+}
+
+json5_value * json5_value_intern_value (json5_value * value, json5_key_table * table, char const * key, size_t key_len, uint8_t const ** out_key, int * out_exists) {
+	json5_obj_prop * prop;
+	json5_value * item;
+
+	if (value -> type != JSON5_TYPE_OBJECT) {
+		return NULL;
+	}
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	if ((item = json5_object_keyset_value (value, (uint8_t const *) key, key_len, out_key, out_exists))) {
+		return item;
+	}
+
+	if (!(prop = json5_value_intern_prop (value, table, key, key_len, out_exists))) {
+		return NULL;
+	}
+
+	*out_key = prop -> key;
+
+	return &prop -> value;
+}
+
+void json5_key_table_clear (json5_key_table * table) {
+	if (!table -> len) {
+		return;
+	}
+
+	for (size_t i = 0; i < table -> cap; i ++) {
+		if (table -> keys [i]) {
+			json5_key_release (table -> keys [i]);
+			table -> keys [i] = NULL;
+		}
+	}
+
+	table -> len = 0;
+}
+
+void json5_key_table_destroy (json5_key_table * table) {
+	json5_key_table_clear (table);
+	free (table -> keys);
+
+	memset (table, 0, sizeof (*table));
+}
+
+static int json5_compare_keys (void const * a, void const * b) {
+	uintptr_t key_a = (uintptr_t) *(uint8_t const * const *) a;
+	uintptr_t key_b = (uintptr_t) *(uint8_t const * const *) b;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * Delete property at @p idx. Properties of objects without index are moved
+ * down. Otherwise @p slot is the index slot of the property or `NOT_FOUND`.
+ */
+static void json5_object_delete (json5_value * value, size_t idx, size_t slot) {
+	json5_object_header * header = json5_object_get_header (value -> props);
+	json5_obj_prop * prop = &value -> props [idx];
+
+	if (header -> index_cap && slot == NOT_FOUND) {
+		json5_object_find (value -> props, prop -> hash, prop -> key, prop -> key_len, &slot);
+	}
+
+	json5_key_release (prop -> key);
+	json5_value_set_null (&prop -> value);
+	value -> len --;
+
+	if (!header -> index_cap) {
+		memmove (prop, prop + 1, (header -> used - idx - 1) * sizeof (*prop));
+		header -> used --;
+
+		return;
+	}
+
+	json5_ctrl_set (json5_object_get_ctrl (header), header -> index_cap, slot, CTRL_DELETED);
+	prop -> key = NULL;
+}
+
+size_t json5_value_retain_props (json5_value * value, uint8_t const * const * keys, size_t count) {
+	size_t deleted = 0;
+	json5_object_header * header;
+	json5_obj_prop * prop;
+
+	if (value -> type != JSON5_TYPE_OBJECT || !value -> props) {
+		return 0;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		json5_keyset_header * keyset = json5_object_get_keyset (header);
+		uint8_t const * key;
+
+		for (size_t id = 0; id < header -> used; id ++) {
+			key = (uint8_t const *) keyset -> keyset -> keys [id].key;
+
+			if ((keyset -> present & ((uint64_t) 1 << id)) && !bsearch (&key, keys, count, sizeof (*keys), json5_compare_keys)) {
+				json5_value_set_null (&json5_object_get_values (value -> props) [id]);
+				keyset -> present &= ~((uint64_t) 1 << id);
+				value -> len --;
+				deleted ++;
+			}
+		}
+
+		return deleted;
+	}
+
+	if (json5_object_get_old (header)) {
+		json5_object_migrate (header, SIZE_MAX);
+	}
+
+	for (size_t i = 0; i < header -> used;) {
+		prop = &value -> props [i];
+
+		if (prop -> key && !bsearch (&prop -> key, keys, count, sizeof (*keys), json5_compare_keys)) {
+			json5_object_delete (value, i, NOT_FOUND);
+			deleted ++;
+
+			// the next property was moved to this index
+			if (!header -> index_cap) {
+				continue;
+			}
+		}
+
+		i ++;
+	}
+
+	if (deleted && header -> index_cap) {
+		json5_object_rehash (value);
+	}
+
+	return deleted;
+}
+
+/**
+ * Defines a key with the position of its first occurrence.
+ */
+typedef struct {
+	uint8_t const * key;
+	size_t rank;
+} json5_key_rank;
+
+/**
+ * Defines a property with its new position.
+ */
+typedef struct {
+	size_t rank;
+	json5_obj_prop prop;
+} json5_prop_rank;
+
+static int json5_compare_key_ranks (void const * a, void const * b) {
+	json5_key_rank const * rank_a = a;
+	json5_key_rank const * rank_b = b;
+	int res = json5_compare_keys (&rank_a -> key, &rank_b -> key);
+
+	if (res) {
+		return res;
+	}
+
+	return (rank_a -> rank > rank_b -> rank) - (rank_a -> rank < rank_b -> rank);
+}
+
+static int json5_compare_prop_ranks (void const * a, void const * b) {
+	size_t rank_a = ((json5_prop_rank const *) a) -> rank;
+	size_t rank_b = ((json5_prop_rank const *) b) -> rank;
+
+	return (rank_a > rank_b) - (rank_a < rank_b);
+}
+
+int json5_value_order_props (json5_value * value, uint8_t const * const * keys, size_t count) {
+	int res = -1;
+	json5_object_header * header;
+	json5_obj_prop * props = value -> props;
+	json5_key_rank * ranks = NULL;
+	json5_prop_rank * ordered = NULL;
+	json5_key_rank * found;
+	json5_key_rank search;
+	size_t used = 0;
+
+	if (value -> type != JSON5_TYPE_OBJECT || !value -> len || !count) {
+		return 0;
+	}
+
+	header = json5_object_get_header (props);
+
+	// ordered by key ID
+	if (json5_object_is_keyset (header)) {
+		return 0;
+	}
+
+	if (json5_object_get_old (header)) {
+		json5_object_migrate (header, SIZE_MAX);
+	}
+
+	// same keys in same order
+	if (header -> used == count) {
+		while (used < count && props [used].key == keys [used]) {
+			used ++;
+		}
 
-	if (!new_key) {
-		return NULL;
+		if (used == count) {
+			return 0;
+		}
 	}
 
-	if (prop -> key >= PLACEHOLDER_KEY) {
-		free (prop -> key);
+	if (!(ranks = malloc (count * sizeof (*ranks))) || !(ordered = malloc (value -> len * sizeof (*ordered)))) {
+		goto cleanup;
 	}
-	else {
-		value -> len ++;
+
+	for (size_t i = 0; i < count; i ++) {
+		ranks [i].key = keys [i];
+		ranks [i].rank = i;
 	}
 
-	prop -> hash = hash;
-	prop -> key = new_key;
-	prop -> key_len = key_len;
-	json5_value_set_null (&prop -> value);
+	qsort (ranks, count, sizeof (*ranks), json5_compare_key_ranks);
 
-	return &prop -> value;
+	// other properties follow in their current order
+	used = 0;
+
+	for (size_t i = 0; i < header -> used; i ++) {
+		if (!props [i].key) {
+			continue;
+		}
+
+		search.key = props [i].key;
+		search.rank = 0;
+		found = bsearch (&search, ranks, count, sizeof (*ranks), json5_compare_keys);
+
+		// first occurrence of key
+		while (found && found > ranks && found [-1].key == found -> key) {
+			found --;
+		}
+
+		ordered [used].rank = found ? found -> rank : count + i;
+		ordered [used].prop = props [i];
+		used ++;
+	}
+
+	qsort (ordered, used, sizeof (*ordered), json5_compare_prop_ranks);
+
+	for (size_t i = 0; i < used; i ++) {
+		props [i] = ordered [i].prop;
+	}
+
+	header -> used = used;
+
+	if (header -> index_cap) {
+		json5_object_build_index (header);
+	}
+
+	res = 0;
+
+	cleanup: {
+		free (ranks);
+		free (ordered);
+
+		return res;
+	}
 }
 
 int json5_value_delete_prop (json5_value * value, char const * key, size_t key_len) {
-	json5_hash hash;
+	json5_object_header * header, * old;
 	json5_obj_prop * prop;
+	json5_hash hash;
+	size_t idx, slot = NOT_FOUND;
 
 	if (value -> type != JSON5_TYPE_OBJECT) {
 		return 0;
 	}
 
-	if (value -> cap == 0) {
+	if (!value -> props) {
 		return 0;
 	}
 
-	hash = json5_get_hash (key, key_len);
-	prop = json5_prop_lookup (value -> props, value -> cap, hash, (uint8_t const *) key, key_len);
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		json5_keyset_header * keyset = json5_object_get_keyset (header);
+
+		idx = json5_keyset_lookup (keyset -> keyset, (uint8_t const *) key, key_len, NULL);
 
-	if (prop -> key) {
-		free (prop -> key);
-		prop -> key = PLACEHOLDER_KEY;
-		json5_value_reset (&prop -> value, JSON5_TYPE_NULL);
+		if (idx == NOT_FOUND || !(keyset -> present & ((uint64_t) 1 << idx))) {
+			return 0;
+		}
+
+		json5_value_set_null (&json5_object_get_values (value -> props) [idx]);
+		keyset -> present &= ~((uint64_t) 1 << idx);
 		value -> len --;
 
 		return 1;
 	}
 
+	if (!header -> index_cap) {
+		idx = json5_object_scan (value -> props, (uint8_t const *) key, key_len);
+	}
+	else {
+		hash = json5_hash_key (key, key_len);
+		idx = json5_object_find (value -> props, hash, (uint8_t const *) key, key_len, &slot);
+
+		// delete property which is not moved yet from the old table
+		if (idx == NOT_FOUND && (old = json5_object_get_old (header)) && (prop = json5_object_find_old (header, hash, (uint8_t const *) key, key_len, &slot))) {
+			json5_key_release (prop -> key);
+			json5_value_set_null (&prop -> value);
+			json5_ctrl_set (json5_object_get_ctrl (old), old -> index_cap, slot, CTRL_DELETED);
+			prop -> key = NULL;
+			value -> len --;
+
+			return 1;
+		}
+	}
+
+	if (idx != NOT_FOUND) {
+		json5_object_delete (value, idx, slot);
+
+		return 1;
+	}
+
 	return 0;
 }
 
@@ -370,37 +1703,446 @@ int json5_obj_itor_init (json5_obj_itor * itor, json5_value const * obj) {
 	}
 
 	itor -> obj = obj;
-	itor -> prop = obj -> props;
+	itor -> idx = 0;
 
 	return 0;
 }
 
 int json5_obj_itor_next (json5_obj_itor * itor, char const ** out_key, size_t * out_key_len, json5_value ** out_value) {
-	json5_obj_prop const * end = &itor -> obj -> props [itor -> obj -> cap];
+	json5_obj_prop * props = itor -> obj -> props;
+	json5_object_header * header;
+	json5_keyset_header * keyset;
+	json5_obj_prop * prop;
+	json5_key const * key;
+	size_t used;
+
+	if (!props) {
+		return 0;
+	}
+
+	header = json5_object_get_header (props);
+	used = header -> used;
+
+	if (json5_object_is_keyset (header)) {
+		keyset = json5_object_get_keyset (header);
+
+		while (itor -> idx < used) {
+			if (keyset -> present & ((uint64_t) 1 << itor -> idx)) {
+				key = &keyset -> keyset -> keys [itor -> idx];
+				*out_value = &json5_object_get_values (props) [itor -> idx];
+				*out_key = key -> key;
+				*out_key_len = key -> key_len;
+
+				itor -> idx ++;
+
+				return 1;
+			}
+
+			itor -> idx ++;
+		}
 
-	if (itor -> prop >= end) {
 		return 0;
 	}
 
-	do {
-		if (itor -> prop -> key > PLACEHOLDER_KEY) {
-			*out_value = &itor -> prop -> value;
-			*out_key = (char const *) itor -> prop -> key;
-			*out_key_len = itor -> prop -> key_len;
+	while (itor -> idx < used) {
+		prop = json5_object_get_prop (props, itor -> idx ++);
 
-			itor -> prop ++;
+		if (prop -> key) {
+			*out_value = &prop -> value;
+			*out_key = (char const *) prop -> key;
+			*out_key_len = prop -> key_len;
 
 			return 1;
 		}
+	}
+
+	return 0;
+}
+
+void json5_key_init (json5_key * key, char const * chars, size_t key_len) {
+	if (key_len == (size_t) -1) {
+		key_len = strlen (chars);
+	}
+
+	key -> key = chars;
+	key -> key_len = key_len;
+	key -> hash = json5_hash_key (chars, key_len);
+	key -> seed = hash_table_seed;
+	key -> func = hash_table_func;
+}
+
+json5_value * json5_value_get_key (json5_value * value, json5_key const * key) {
+	json5_hash const * hash = &key -> hash;
+
+	if (value -> type != JSON5_TYPE_OBJECT) {
+		return NULL;
+	}
+
+	// hash is not valid anymore
+	if (key -> seed != hash_table_seed || key -> func != hash_table_func) {
+		hash = NULL;
+	}
+
+	return json5_object_get (value, (uint8_t const *) key -> key, key -> key_len, hash);
+}
+
+/**
+ * Append an uninitialized item to @p path.
+ */
+static json5_path_item * json5_path_append (json5_path * path) {
+	json5_path_item * items;
+	size_t new_cap;
+
+	if (path -> len >= path -> cap) {
+		new_cap = path -> cap ? path -> cap * 2 : PATH_MIN_CAP;
+
+		if (!(items = realloc (path -> items, new_cap * sizeof (*items)))) {
+			return NULL;
+		}
+
+		path -> items = items;
+		path -> cap = new_cap;
+	}
+
+	return &path -> items [path -> len ++];
+}
+
+int json5_path_append_key (json5_path * path, char const * key, size_t key_len) {
+	json5_path_item * item;
+	char * chars;
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	if (key_len == SIZE_MAX || !(chars = malloc (key_len + 1))) {
+		return -1;
+	}
+
+	if (!(item = json5_path_append (path))) {
+		free (chars);
+
+		return -1;
+	}
+
+	memcpy (chars, key, key_len);
+	chars [key_len] = '\0';
+
+	json5_key_init (&item -> key, chars, key_len);
+	item -> index = 0;
+
+	return 0;
+}
+
+int json5_path_append_index (json5_path * path, size_t index) {
+	json5_path_item * item;
+
+	if (!(item = json5_path_append (path))) {
+		return -1;
+	}
+
+	memset (&item -> key, 0, sizeof (item -> key));
+	item -> index = index;
+
+	return 0;
+}
+
+void json5_path_destroy (json5_path * path) {
+	for (size_t i = 0; i < path -> len; i ++) {
+		// keys of paths are copies
+		free ((void *) (uintptr_t) path -> items [i].key.key);
+	}
+
+	free (path -> items);
+
+	memset (path, 0, sizeof (*path));
+}
+
+json5_value * json5_value_get_path (json5_value * root, json5_path const * path) {
+	json5_path_item const * item;
+	json5_value * value = root;
+
+	for (size_t i = 0; i < path -> len && value; i ++) {
+		item = &path -> items [i];
+
+		if (item -> key.key) {
+			value = json5_value_get_key (value, &item -> key);
+		}
+		else if (value -> type == JSON5_TYPE_ARRAY && item -> index < value -> len) {
+			value = &value -> items [item -> index];
+		}
+		else {
+			value = NULL;
+		}
+	}
+
+	return value;
+}
+
+/**
+ * Find a displacement for @p bucket, so all keys in @p members map to
+ * distinct free slots.
+ */
+static int json5_keyset_place (json5_keyset * keyset, size_t bucket, size_t const * members, size_t count) {
+	size_t slots [JSON5_KEYSET_MAX_LEN];
+	size_t i, j;
+
+	for (uint32_t disp = 0; disp < KEYSET_MAX_DISP; disp ++) {
+		for (i = 0; i < count; i ++) {
+			slots [i] = json5_keyset_slot (keyset -> keys [members [i]].hash, disp, keyset -> slot_mask);
+
+			if (keyset -> ids [slots [i]] != KEYSET_EMPTY) {
+				break;
+			}
+
+			// keys of the same bucket need distinct slots
+			for (j = 0; j < i; j ++) {
+				if (slots [j] == slots [i]) {
+					break;
+				}
+			}
+
+			if (j < i) {
+				break;
+			}
+		}
+
+		if (i == count) {
+			for (i = 0; i < count; i ++) {
+				keyset -> ids [slots [i]] = members [i];
+			}
+
+			keyset -> disps [bucket] = disp;
+
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int json5_keyset_init (json5_keyset * keyset, char const * const * keys, size_t count) {
+	size_t bucket_cap = 1;
+	size_t slot_cap = 1;
+	size_t sizes [JSON5_KEYSET_MAX_LEN];
+	size_t members [JSON5_KEYSET_MAX_LEN];
+	size_t max_size = 0;
+	size_t key_len, n;
+	uint8_t * chars;
+
+	memset (keyset, 0, sizeof (*keyset));
+
+	if (count > JSON5_KEYSET_MAX_LEN) {
+		return -1;
+	}
+
+	// about one key per bucket and at most half of the slots used
+	while (bucket_cap < count) {
+		bucket_cap *= 2;
+	}
+
+	while (slot_cap < count * 2) {
+		slot_cap *= 2;
+	}
+
+	keyset -> keys = calloc (count ? count : 1, sizeof (*keyset -> keys));
+	keyset -> disps = calloc (bucket_cap, sizeof (*keyset -> disps));
+	keyset -> ids = malloc (slot_cap);
+
+	if (!keyset -> keys || !keyset -> disps || !keyset -> ids) {
+		goto error;
+	}
+
+	keyset -> bucket_mask = bucket_cap - 1;
+	keyset -> slot_mask = slot_cap - 1;
+	keyset -> seed = hash_table_seed;
+	keyset -> func = hash_table_func;
+	memset (keyset -> ids, KEYSET_EMPTY, slot_cap);
+	memset (sizes, 0, sizeof (sizes));
+
+	for (size_t i = 0; i < count; i ++) {
+		key_len = strlen (keys [i]);
+
+		for (size_t j = 0; j < i; j ++) {
+			if (keyset -> keys [j].key_len == key_len && memcmp (keyset -> keys [j].key, keys [i], key_len) == 0) {
+				goto error;
+			}
+		}
+
+		if (!(chars = json5_key_create ((uint8_t const *) keys [i], key_len, json5_hash_key (keys [i], key_len)))) {
+			goto error;
+		}
+
+		json5_key_init (&keyset -> keys [i], (char const *) chars, key_len);
+		keyset -> len ++;
+
+		n = ++ sizes [json5_keyset_bucket (keyset -> keys [i].hash, keyset -> bucket_mask)];
+		max_size = n > max_size ? n : max_size;
+	}
+
+	// place buckets with most keys first
+	for (size_t size = max_size; size > 0; size --) {
+		for (size_t bucket = 0; bucket < bucket_cap; bucket ++) {
+			if (sizes [bucket] != size) {
+				continue;
+			}
+
+			n = 0;
+
+			for (size_t i = 0; i < count; i ++) {
+				if (json5_keyset_bucket (keyset -> keys [i].hash, keyset -> bucket_mask) == bucket) {
+					members [n ++] = i;
+				}
+			}
 
-		itor -> prop ++;
+			if (json5_keyset_place (keyset, bucket, members, n) != 0) {
+				goto error;
+			}
+		}
 	}
-	while (itor -> prop < end);
 
 	return 0;
+
+	error: {
+		json5_keyset_destroy (keyset);
+
+		return -1;
+	}
+}
+
+void json5_keyset_destroy (json5_keyset * keyset) {
+	// properties converted from objects using the key set share the keys
+	for (size_t i = 0; i < keyset -> len; i ++) {
+		json5_key_release ((uint8_t *) (uintptr_t) keyset -> keys [i].key);
+	}
+
+	free (keyset -> keys);
+	free (keyset -> disps);
+	free (keyset -> ids);
+
+	memset (keyset, 0, sizeof (*keyset));
+}
+
+ssize_t json5_keyset_find (json5_keyset const * keyset, char const * key, size_t key_len) {
+	size_t id;
+
+	if (key_len == (size_t) -1) {
+		key_len = strlen (key);
+	}
+
+	id = json5_keyset_lookup (keyset, (uint8_t const *) key, key_len, NULL);
+
+	return id != NOT_FOUND ? (ssize_t) id : -1;
+}
+
+int json5_value_use_keyset (json5_value * value, json5_keyset const * keyset) {
+	json5_object_header * header;
+	json5_keyset_header * new_header;
+	json5_value * values;
+	json5_obj_prop * prop;
+	size_t ids [JSON5_KEYSET_MAX_LEN];
+	uint64_t present = 0;
+	size_t id, count = 0;
+
+	if (value -> type != JSON5_TYPE_OBJECT || !value -> len || value -> len > keyset -> len) {
+		return 0;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		return json5_object_get_keyset (header) -> keyset == keyset;
+	}
+
+	if (json5_object_get_old (header)) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < header -> used; i ++) {
+		prop = &value -> props [i];
+
+		if (!prop -> key) {
+			continue;
+		}
+
+		// hashes of objects without index may not be computed
+		id = json5_keyset_lookup (keyset, prop -> key, prop -> key_len, header -> index_cap ? &prop -> hash : NULL);
+
+		if (id == NOT_FOUND) {
+			return 0;
+		}
+
+		ids [count ++] = id;
+	}
+
+	if (!(new_header = malloc (sizeof (*new_header) + keyset -> len * sizeof (*values)))) {
+		return -1;
+	}
+
+	values = (json5_value *) (&new_header -> header + 1);
+
+	for (size_t i = 0, j = 0; i < header -> used; i ++) {
+		prop = &value -> props [i];
+
+		if (prop -> key) {
+			values [ids [j]] = prop -> value;
+			present |= (uint64_t) 1 << ids [j];
+			json5_key_release (prop -> key);
+			j ++;
+		}
+	}
+
+	free (header);
+
+	new_header -> keyset = keyset;
+	new_header -> present = present;
+	new_header -> header.cap = keyset -> len;
+	new_header -> header.used = keyset -> len;
+	new_header -> header.index_cap = INDEX_KEYSET;
+	value -> props = (json5_obj_prop *) values;
+
+	return 1;
+}
+
+json5_value * json5_value_get_key_id (json5_value * value, json5_keyset const * keyset, size_t id) {
+	json5_object_header * header;
+	json5_keyset_header * object_keyset;
+	json5_key const * key;
+	json5_hash const * hash = NULL;
+
+	if (value -> type != JSON5_TYPE_OBJECT || !value -> props || id >= keyset -> len) {
+		return NULL;
+	}
+
+	header = json5_object_get_header (value -> props);
+
+	if (json5_object_is_keyset (header)) {
+		object_keyset = json5_object_get_keyset (header);
+
+		if (object_keyset -> keyset == keyset) {
+			if (!(object_keyset -> present & ((uint64_t) 1 << id))) {
+				return NULL;
+			}
+
+			return &json5_object_get_values (value -> props) [id];
+		}
+	}
+
+	key = &keyset -> keys [id];
+
+	if (key -> seed == hash_table_seed && key -> func == hash_table_func) {
+		hash = &key -> hash;
+	}
+
+	return json5_object_get (value, (uint8_t const *) key -> key, key -> key_len, hash);
 }
 
 void json5_set_hash_seed (json5_hash seed)
 {
 	hash_table_seed = seed;
 }
+
+void json5_set_hash_func (json5_hash_func func)
+{
+	hash_table_func = func;
+}
@@ -30,6 +30,7 @@ typedef enum json5_type json5_type;
 typedef struct json5_value json5_value;
 typedef struct json5_obj_prop json5_obj_prop;
 typedef struct json5_obj_itor json5_obj_itor;
+typedef struct json5_key_table json5_key_table;
 typedef uint64_t json5_hash;
 
 /**
@@ -47,21 +48,29 @@ enum json5_type {
 	JSON5_TYPE_OBJECT,   ///< {...}
 };
 
+/**
+ * Maximum length of strings and number of container items.
+ */
+#define JSON5_VALUE_MAX_LEN UINT32_MAX
+
 /**
  * Defines a value container.
+ *
+ * Strings shorter than `sizeof (chars)` bytes are stored inline. Use
+ * `json5_value_get_string` to access the characters of any string. The
+ * capacity of allocated strings, items and properties is stored in front of
+ * their memory block.
  */
 struct json5_value {
 	json5_type type; ///< Value type.
-	struct {
-		union {
-			int64_t ival;           ///< Integer value.
-			double fval;            ///< Float value.
-			uint8_t * sval;         ///< String value.
-			json5_value * items;    ///< Array items.
-			json5_obj_prop * props; ///< Object properties.
-		};
-		size_t len; ///< Number of container item.
-		size_t cap; ///< Container capacity.
+	uint32_t len;    ///< Number of container items or string length in bytes.
+	union {
+		int64_t ival;           ///< Integer value.
+		double fval;            ///< Float value.
+		uint8_t * sval;         ///< Allocated string value.
+		json5_value * items;    ///< Array items.
+		json5_obj_prop * props; ///< Object properties.
+		uint8_t chars [8];      ///< Inline string value.
 	};
 };
 
@@ -70,7 +79,7 @@ struct json5_value {
  */
 struct json5_obj_prop {
 	json5_hash hash;   ///< The property hash.
-	uint8_t * key;     ///< The property key.
+	uint8_t * key;     ///< The property key. May be shared with other properties.
 	size_t key_len;    ///< The property key length in bytes.
 	json5_value value; ///< The property value.
 };
@@ -80,7 +89,20 @@ struct json5_obj_prop {
  */
 struct json5_obj_itor {
 	json5_value const * obj; ///< The object to iterator
-	json5_obj_prop * prop;   ///< The current property.
+	size_t idx;              ///< The index of the next property.
+};
+
+/**
+ * Defines a table of interned object keys.
+ *
+ * Properties inserted with `json5_value_intern_prop` share one immutable
+ * copy of each key. Keys are reference counted and stay valid as long as a
+ * property uses them, also after the table is cleared.
+ */
+struct json5_key_table {
+	uint8_t ** keys; ///< Interned keys or `NULL` for empty slots.
+	size_t len;      ///< Number of interned keys.
+	size_t cap;      ///< Number of slots.
 };
 
 /**
@@ -144,10 +166,24 @@ static inline void json5_value_set_null (json5_value * value);
  * @param str The string to set. Can contain `NUL` bytes.
  * @param len The string length in bytes.
  *
- * @return 0 on success otherwise a value != 0 indicating an allocation error.
+ * @return 0 on success otherwise a value != 0 indicating an allocation error
+ * or a string longer than `JSON5_VALUE_MAX_LEN`.
  */
 extern int json5_value_set_string (json5_value * value, char const * str, size_t len);
 
+/**
+ * Get the characters of a string value.
+ *
+ * Short strings are stored inside the value itself, so the characters are
+ * only valid as long as the value is not changed or moved.
+ *
+ * @param value The string value.
+ *
+ * @return The null-terminated characters or `NULL` if @p value is not a
+ * string. The length is given by `value -> len`.
+ */
+static inline uint8_t const * json5_value_get_string (json5_value const * value);
+
 /**
  * Set to empty array. If the value is already an array, nothing is done.
  *
@@ -192,6 +228,18 @@ extern json5_value * json5_value_get_item (json5_value * value, size_t idx);
  */
 extern json5_value * json5_value_append_item (json5_value * value);
 
+/**
+ * Reserve memory for at least @p cap items of an array.
+ *
+ * @param value The array value.
+ * @param cap The number of items to reserve.
+ *
+ * @return 0 on success otherwise a value != 0 if @p value is not an array
+ * value, @p cap is larger than `JSON5_VALUE_MAX_LEN` or an allocation error
+ * occured.
+ */
+extern int json5_value_reserve (json5_value * value, size_t cap);
+
 /**
  * Get property of object @p value with given @p key.
  *
@@ -218,6 +266,79 @@ extern json5_value * json5_value_get_prop (json5_value * value, char const * key
  */
 extern json5_value * json5_value_set_prop (json5_value * value, char const * key, size_t key_len, int replace);
 
+/**
+ * Get or insert object property with key. The value of an existing property
+ * is not changed. A new property is initialized with `null`.
+ *
+ * @param value The object value to insert a property.
+ * @param key The property key.
+ * @param key_len The property key length in bytes.
+ * @param out_exists Set to 1 if the property already existed otherwise 0.
+ *
+ * @return The property with the given @p key otherwise `NULL` if @p value is
+ * not an object value or an allocation error occured. The property is only
+ * valid until the next property is inserted.
+ */
+extern json5_obj_prop * json5_value_insert_prop (json5_value * value, char const * key, size_t key_len, int * out_exists);
+
+/**
+ * Get or insert object property like `json5_value_insert_prop`, but share
+ * the key of a new property with all properties inserted with the same
+ * @p table. Lookups of shared keys only compare pointers.
+ *
+ * @param value The object value to insert a property.
+ * @param table The table of interned keys.
+ * @param key The property key.
+ * @param key_len The property key length in bytes.
+ * @param out_exists Set to 1 if the property already existed otherwise 0.
+ *
+ * @return The property with the given @p key otherwise `NULL` if @p value is
+ * not an object value or an allocation error occured. The property is only
+ * valid until the next property is inserted.
+ */
+extern json5_obj_prop * json5_value_intern_prop (json5_value * value, json5_key_table * table, char const * key, size_t key_len, int * out_exists);
+
+/**
+ * Release all keys of a key table. The allocated memory will be preserved.
+ * Keys used by properties stay valid.
+ *
+ * @param table The key table to clear.
+ */
+extern void json5_key_table_clear (json5_key_table * table);
+
+/**
+ * Destroy a key table.
+ *
+ * @param table The key table to destroy.
+ */
+extern void json5_key_table_destroy (json5_key_table * table);
+
+/**
+ * Delete all object properties whose key pointers are not contained in
+ * @p keys.
+ *
+ * @param value The object value to delete properties from.
+ * @param keys Key pointers of properties of @p value sorted by address.
+ * @param count The number of keys.
+ *
+ * @return The number of deleted properties.
+ */
+extern size_t json5_value_retain_props (json5_value * value, uint8_t const * const * keys, size_t count);
+
+/**
+ * Move object properties to the order of the first occurrence of their key
+ * pointers in @p keys. Properties whose keys are not contained in @p keys
+ * follow in their current order. Objects using a key set stay ordered by key
+ * ID.
+ *
+ * @param value The object value to reorder.
+ * @param keys Key pointers of properties of @p value in the new order.
+ * @param count The number of keys.
+ *
+ * @return 0 on success or -1 if an allocation error occured.
+ */
+extern int json5_value_order_props (json5_value * value, uint8_t const * const * keys, size_t count);
+
 /**
  * Delete object property with key.
  *
@@ -250,7 +371,7 @@ extern void json5_value_transfer (json5_value * target, json5_value * source);
 extern int json5_obj_itor_init (json5_obj_itor * itor, json5_value const * obj);
 
 /**
- * Get next key-value pair.
+ * Get next key-value pair. Properties are returned in insertion order.
  *
  * @param itor Iterator to iterate.
  * @param out_key A reference set to the current property key.
@@ -270,6 +391,222 @@ extern int json5_obj_itor_next (json5_obj_itor * itor, char const ** out_key, si
  */
 extern void json5_set_hash_seed (json5_hash seed);
 
+/**
+ * Defines hash functions for object keys.
+ */
+typedef enum {
+	JSON5_HASH_FAST = 0, ///< Fast keyed hash. The default.
+	JSON5_HASH_SIP,      ///< SipHash-1-3. Slower, but resistant to collision attacks.
+} json5_hash_func;
+
+/**
+ * Sets the global hash function for object keys. Like the seed, it has to be
+ * set before creating any object values. Use `JSON5_HASH_SIP` together with
+ * a random seed when decoding input from untrusted sources.
+ *
+ * @param func The hash function.
+ */
+extern void json5_set_hash_func (json5_hash_func func);
+
+/**
+ * Hash an object key with the global hash function and seed.
+ *
+ * @param key The key to hash.
+ * @param key_len The key length in bytes. If -1, `strlen` is used.
+ *
+ * @return The key hash.
+ */
+extern json5_hash json5_hash_key (char const * key, size_t key_len);
+
+/**
+ * Defines an object key with precomputed hash for repeated lookups.
+ */
+typedef struct {
+	char const * key;     ///< The key bytes.
+	size_t key_len;       ///< The key length in bytes.
+	json5_hash hash;      ///< The key hash.
+	json5_hash seed;      ///< The seed used to compute the hash.
+	json5_hash_func func; ///< The function used to compute the hash.
+} json5_key;
+
+/**
+ * Defines a path item. Either an object key or an array index.
+ */
+typedef struct {
+	json5_key key; ///< The object key if `key.key` is not `NULL`.
+	size_t index;  ///< The array index otherwise.
+} json5_path_item;
+
+/**
+ * Defines a path of object keys and array indexes. Paths with cleared memory
+ * are empty.
+ */
+typedef struct {
+	json5_path_item * items; ///< The path items.
+	size_t len;              ///< Number of path items.
+	size_t cap;              ///< Item capacity.
+} json5_path;
+
+/**
+ * Initialize a key and compute its hash with the global hash function and
+ * seed. If they are changed later, lookups hash the key again.
+ *
+ * @param key The key to initialize.
+ * @param chars The key bytes. They are not copied and have to be valid as long
+ * as the key is used.
+ * @param key_len The key length in bytes. If -1, `strlen` is used.
+ */
+extern void json5_key_init (json5_key * key, char const * chars, size_t key_len);
+
+/**
+ * Get object property value with a precomputed key.
+ *
+ * @param value The object value.
+ * @param key The key to search for.
+ *
+ * @return The property value otherwise `NULL` if @p value is not an object or
+ * no property with the given key exists.
+ */
+extern json5_value * json5_value_get_key (json5_value * value, json5_key const * key);
+
+/**
+ * Append an object key to a path. The key is copied.
+ *
+ * @param path The path to append the key to.
+ * @param key The object key.
+ * @param key_len The key length in bytes. If -1, `strlen` is used.
+ *
+ * @return 0 on success or -1 if an allocation error occured.
+ */
+extern int json5_path_append_key (json5_path * path, char const * key, size_t key_len);
+
+/**
+ * Append an array index to a path.
+ *
+ * @param path The path to append the index to.
+ * @param index The array index.
+ *
+ * @return 0 on success or -1 if an allocation error occured.
+ */
+extern int json5_path_append_index (json5_path * path, size_t index);
+
+/**
+ * Destroy a path.
+ *
+ * @param path The path to destroy.
+ */
+extern void json5_path_destroy (json5_path * path);
+
+/**
+ * Get value at @p path starting at @p root. Keys are not hashed again.
+ *
+ * @param root The value to start at.
+ * @param path The path to follow.
+ *
+ * @return The value at @p path otherwise `NULL` if a key or index does not
+ * exist or a value on the path has the wrong type.
+ */
+extern json5_value * json5_value_get_path (json5_value * root, json5_path const * path);
+
+/**
+ * Maximum number of keys in a key set.
+ */
+#define JSON5_KEYSET_MAX_LEN 64
+
+/**
+ * Defines a static set of object keys with a perfect hash function.
+ *
+ * Objects containing only keys of the set can store their values in an array
+ * indexed by key ID instead of a property table. Such objects are converted
+ * back to a property table when a key not contained in the set is inserted or
+ * a property is requested with `json5_value_insert_prop`.
+ */
+typedef struct {
+	json5_key * keys;     ///< The keys in ID order.
+	size_t len;           ///< Number of keys.
+	uint32_t * disps;     ///< Hash displacement per bucket.
+	uint8_t * ids;        ///< Key ID per slot or `UINT8_MAX` if empty.
+	size_t bucket_mask;   ///< Number of buckets minus 1.
+	size_t slot_mask;     ///< Number of slots minus 1.
+	json5_hash seed;      ///< The seed used to build the hash function.
+	json5_hash_func func; ///< The function used to build the hash function.
+} json5_keyset;
+
+/**
+ * Initialize a key set and build its hash function. The keys get IDs in the
+ * given order. Has to be called after setting the global hash function and
+ * seed, otherwise lookups compare all keys.
+ *
+ * @param keyset The key set to initialize.
+ * @param keys The keys. They are copied.
+ * @param count The number of keys.
+ *
+ * @return 0 on success or -1 if the keys contain duplicates, more than
+ * `JSON5_KEYSET_MAX_LEN` keys are given or an allocation error occured.
+ */
+extern int json5_keyset_init (json5_keyset * keyset, char const * const * keys, size_t count);
+
+/**
+ * Destroy a key set. Objects using the key set have to be destroyed or
+ * converted before.
+ *
+ * @param keyset The key set to destroy.
+ */
+extern void json5_keyset_destroy (json5_keyset * keyset);
+
+/**
+ * Get ID of a key in a key set.
+ *
+ * @param keyset The key set.
+ * @param key The key to search for.
+ * @param key_len The key length in bytes. If -1, `strlen` is used.
+ *
+ * @return The key ID or -1 if the key is not in the set.
+ */
+extern ssize_t json5_keyset_find (json5_keyset const * keyset, char const * key, size_t key_len);
+
+/**
+ * Store the values of object @p value in an array indexed by key ID if all
+ * keys belong to @p keyset. The properties are then iterated in key ID order.
+ *
+ * @param value The object value to convert.
+ * @param keyset The key set. Has to be valid as long as the object uses it.
+ *
+ * @return 1 if the object uses the key set, 0 if it is not an object, empty
+ * or contains other keys, or -1 if an allocation error occured.
+ */
+extern int json5_value_use_keyset (json5_value * value, json5_keyset const * keyset);
+
+/**
+ * Get object property value by key ID. Objects using @p keyset are indexed
+ * directly; other objects are searched for the key with the given ID.
+ *
+ * @param value The object value.
+ * @param keyset The key set.
+ * @param id The key ID.
+ *
+ * @return The property value otherwise `NULL` if @p value is not an object or
+ * no property with the given key exists.
+ */
+extern json5_value * json5_value_get_key_id (json5_value * value, json5_keyset const * keyset, size_t id);
+
+/**
+ * Get or insert object property value like `json5_value_intern_prop`. Objects
+ * using a key set are only converted if @p key is not contained in the set.
+ *
+ * @param value The object value to insert a property.
+ * @param table The table of interned keys.
+ * @param key The property key.
+ * @param key_len The property key length in bytes.
+ * @param out_key Set to the key pointer identifying the property, as used by
+ * `json5_value_retain_props` and returned by `json5_obj_itor_next`.
+ * @param out_exists Set to 1 if the property already existed otherwise 0.
+ *
+ * @return The property value otherwise `NULL` if @p value is not an object
+ * value or an allocation error occured. The value is only valid until the next
+ * property is inserted.
+ */
+extern json5_value * json5_value_intern_value (json5_value * value, json5_key_table * table, char const * key, size_t key_len, uint8_t const ** out_key, int * out_exists);
 
 static inline void json5_value_set_int (json5_value * value, int64_t i) {
 	if (value -> type != JSON5_TYPE_INT) {
@@ -345,6 +682,14 @@ static inline void json5_value_set_null (json5_value * value) {
 	}
 }
 
+static inline uint8_t const * json5_value_get_string (json5_value const * value) {
+	if (value -> type != JSON5_TYPE_STRING) {
+		return NULL;
+	}
+
+	return value -> len < sizeof (value -> chars) ? value -> chars : value -> sval;
+}
+
 static inline void json5_value_set_array (json5_value * value) {
 	if (value -> type != JSON5_TYPE_ARRAY) {
 		if (value -> type >= JSON5_TYPE_STRING) {
@@ -352,6 +697,7 @@ static inline void json5_value_set_array (json5_value * value) {
 		}
 		else {
 			value -> type = JSON5_TYPE_ARRAY;
+			value -> len = 0;
 			value -> items = NULL;
 		}
 	}
@@ -364,6 +710,7 @@ static inline void json5_value_set_object (json5_value * value) {
 		}
 		else {
 			value -> type = JSON5_TYPE_OBJECT;
+			value -> len = 0;
 			value -> props = NULL;
 		}
 	}
@@ -27,7 +27,6 @@
 #include "json5-writer.h"
 
 #define BUFFER_CAP 4096
-#define PLACEHOLDER_KEY ((uint8_t *) 1)
 
 enum
 {
@@ -271,7 +270,7 @@ static int json5_writer_write_string (json5_writer * writer, json5_value const *
 		return -1;
 	}
 
-	if ((res = json5_writer_write_escaped_bytes (writer, value -> sval, value -> len)) != 0) {
+	if ((res = json5_writer_write_escaped_bytes (writer, json5_value_get_string (value), value -> len)) != 0) {
 		return res;
 	}
 
@@ -311,14 +310,14 @@ static int json5_writer_write_array (json5_writer * writer, json5_value const *
 	return 0;
 }
 
-static int json5_writer_write_prop (json5_writer * writer, json5_obj_prop const * prop) {
+static int json5_writer_write_prop (json5_writer * writer, char const * key, size_t key_len, json5_value const * value) {
 	int res;
 
 	if ((res = json5_writer_write_byte (writer, '"')) != 0) {
 		return -1;
 	}
 
-	if ((res = json5_writer_write_escaped_bytes (writer, (void const *) prop -> key, prop -> key_len)) != 0) {
+	if ((res = json5_writer_write_escaped_bytes (writer, (void const *) key, key_len)) != 0) {
 		return -1;
 	}
 
@@ -330,7 +329,7 @@ static int json5_writer_write_prop (json5_writer * writer, json5_obj_prop const
 		return -1;
 	}
 
-	if ((res = json5_writer_write_value (writer, &prop -> value)) != 0) {
+	if ((res = json5_writer_write_value (writer, value)) != 0) {
 		return -1;
 	}
 
@@ -339,25 +338,26 @@ static int json5_writer_write_prop (json5_writer * writer, json5_obj_prop const
 
 static int json5_writer_write_object (json5_writer * writer, json5_value const * value) {
 	int res;
-	size_t cap = value -> len;
-	json5_obj_prop const * item;
+	size_t count = value -> len;
+	char const * key;
+	size_t key_len;
+	json5_value * prop;
+	json5_obj_itor itor;
 
 	if ((res = json5_writer_write_byte (writer, '{')) != 0) {
 		return -1;
 	}
 
-	for (size_t i = 0; i < value -> cap; i ++) {
-		item = &value -> props [i];
+	json5_obj_itor_init (&itor, value);
 
-		if (item -> key > PLACEHOLDER_KEY) {
-			if ((res = json5_writer_write_prop (writer, item)) != 0) {
-				return -1;
-			}
+	while (json5_obj_itor_next (&itor, &key, &key_len, &prop)) {
+		if ((res = json5_writer_write_prop (writer, key, key_len, prop)) != 0) {
+			return -1;
+		}
 
-			if (cap -- > 1) {
-				if ((res = json5_writer_write_byte (writer, ',')) != 0) {
-					return -1;
-				}
+		if (count -- > 1) {
+			if ((res = json5_writer_write_byte (writer, ',')) != 0) {
+				return -1;
 			}
 		}
 	}
@@ -32,8 +32,17 @@ extern "C" {
 #endif
 
 #include "json5-coder.h"
+#include "json5-coder-pool.h"
+#include "json5-document.h"
+#include "json5-hash.h"
+#include "json5-matcher.h"
+#include "json5-parallel.h"
 #include "json5-parser.h"
+#include "json5-pipeline.h"
+#include "json5-reader.h"
+#include "json5-thread-pool.h"
 #include "json5-tokenizer.h"
+#include "json5-validator.h"
 #include "json5-value.h"
 #include "json5-writer.h"
 
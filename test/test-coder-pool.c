@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include "test.h"
+
+static void * decode_thread (void * arg) {
+	json5_coder_pool * pool = arg;
+	json5_coder * coder;
+	json5_value value = JSON5_VALUE_INIT;
+	char const * input = "{a: [1, 2, {b: 'c'}]}";
+
+	for (size_t i = 0; i < 1000; i ++) {
+		assert ((coder = json5_coder_pool_get (pool)) != NULL);
+		assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+		assert (json5_value_get_prop (&value, "a", 1) -> len == 3);
+		json5_coder_pool_put (pool, coder);
+	}
+
+	json5_value_set_null (&value);
+
+	return NULL;
+}
+
+int main (int argc, char const * argv []) {
+	json5_coder_pool pool;
+	json5_coder_pool_stats stats;
+	json5_coder * coder1;
+	json5_coder * coder2;
+	json5_value value = JSON5_VALUE_INIT;
+	pthread_t threads [4];
+	char * large;
+	size_t size = 100000;
+	size_t len;
+
+	assert (json5_coder_pool_init (&pool, 2, 64 * 1024) == 0);
+
+	assert ((coder1 = json5_coder_pool_get (&pool)) != NULL);
+	json5_coder_pool_put (&pool, coder1);
+	assert ((coder2 = json5_coder_pool_get (&pool)) == coder1);
+
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.hits == 1);
+	assert (stats.misses == 1);
+
+	// large string grows tokenizer buffer beyond maximum size
+	large = malloc (size + 2);
+	memset (large, 'x', size + 2);
+	large [0] = '"';
+	large [size + 1] = '"';
+
+	assert (json5_coder_decode (coder2, (uint8_t const *) large, size + 2, &value) == 0);
+	assert (value.len == size);
+	assert (coder2 -> tknzr.buffer_cap > 64 * 1024);
+
+	json5_coder_pool_put (&pool, coder2);
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.trims == 1);
+	assert (coder2 -> tknzr.buffer_cap <= 64 * 1024);
+
+	// decode again after trimming
+	assert ((coder1 = json5_coder_pool_get (&pool)) == coder2);
+	assert (json5_coder_decode (coder1, (uint8_t const *) large, size + 2, &value) == 0);
+	assert (value.len == size);
+
+	json5_coder_pool_put (&pool, coder1);
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.trims == 2);
+
+	// many keys grow parser buffers beyond maximum size
+	assert ((coder1 = json5_coder_pool_get (&pool)) == coder2);
+	len = sprintf (large, "{");
+
+	for (size_t i = 0; i < 9000; i ++) {
+		len += sprintf (&large [len], "k%zu: 1, ", i);
+	}
+
+	len += sprintf (&large [len], "}");
+	assert (json5_coder_decode (coder1, (uint8_t const *) large, len, &value) == 0);
+	assert (value.len == 9000);
+
+	json5_coder_pool_put (&pool, coder1);
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.trims == 3);
+	assert ((coder1 = json5_coder_pool_get (&pool)) == coder2);
+
+	// pool full
+	coder2 = json5_coder_pool_get (&pool);
+	json5_coder_pool_put (&pool, coder1);
+	json5_coder_pool_put (&pool, coder2);
+	json5_coder_pool_put (&pool, json5_coder_pool_get (&pool));
+	coder1 = json5_coder_pool_get (&pool);
+	coder2 = json5_coder_pool_get (&pool);
+	json5_coder_pool_put (&pool, json5_coder_pool_get (&pool));
+	json5_coder_pool_put (&pool, coder1);
+	json5_coder_pool_put (&pool, coder2);
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.drops == 1);
+
+	for (size_t i = 0; i < 4; i ++) {
+		assert (pthread_create (&threads [i], NULL, decode_thread, &pool) == 0);
+	}
+
+	for (size_t i = 0; i < 4; i ++) {
+		pthread_join (threads [i], NULL);
+	}
+
+	json5_coder_pool_get_stats (&pool, &stats);
+	assert (stats.hits + stats.misses == 4010);
+
+	free (large);
+	json5_value_set_null (&value);
+	json5_coder_pool_destroy (&pool);
+
+	return RESULT_PASS;
+}
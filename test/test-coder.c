@@ -0,0 +1,490 @@
+#include <stdlib.h>
+#include "test.h"
+
+static int decode_doc (json5_value * value, void * arg) {
+	json5_value * docs = arg;
+
+	json5_value_transfer (json5_value_append_item (docs), value);
+
+	return 0;
+}
+
+static void test_docs (json5_coder * coder) {
+	json5_value docs = JSON5_VALUE_INIT;
+	char const * input = "{a: 1}\n[2, 3]\n  'abc' 42\n{b: {c: null}}\n";
+	size_t size = strlen (input);
+
+	json5_value_set_array (&docs);
+	json5_coder_reset (coder);
+
+	// push in small chunks
+	for (size_t i = 0; i < size; i += 5) {
+		size_t chunk = size - i < 5 ? size - i : 5;
+
+		assert (json5_coder_put_docs (coder, (uint8_t const *) &input [i], chunk, decode_doc, &docs) == 0);
+	}
+
+	assert (json5_coder_put_docs (coder, NULL, 0, decode_doc, &docs) == 0);
+
+	assert (docs.len == 5);
+	assert (docs.items [0].type == JSON5_TYPE_OBJECT);
+	assert (json5_value_get_prop (&docs.items [0], "a", 1) -> ival == 1);
+	assert (docs.items [1].type == JSON5_TYPE_ARRAY);
+	assert (docs.items [1].len == 2);
+	assert (docs.items [2].type == JSON5_TYPE_STRING);
+	assert (docs.items [3].type == JSON5_TYPE_INT);
+	assert (docs.items [3].ival == 42);
+	assert (docs.items [4].type == JSON5_TYPE_OBJECT);
+
+	// error in second document
+	json5_value_set_null (&docs);
+	json5_value_set_array (&docs);
+	json5_coder_reset (coder);
+	input = "{a: 1}\n{b: }\n";
+
+	assert (json5_coder_put_docs (coder, (uint8_t const *) input, strlen (input), decode_doc, &docs) != 0);
+	assert (docs.len == 1);
+	assert (json5_coder_get_error (coder) != NULL);
+	assert (strstr (json5_coder_get_error (coder), "line 2") != NULL);
+
+	json5_value_set_null (&docs);
+}
+
+static int decode_item (json5_value * value, void * arg) {
+	json5_value * items = arg;
+
+	json5_value_transfer (json5_value_append_item (items), value);
+
+	return 0;
+}
+
+static void test_items (json5_coder * coder) {
+	json5_value items = JSON5_VALUE_INIT;
+	json5_value * data;
+	char const * input = "[{id: 1}, [2, 3], 'four', 5]";
+	char const * input2 = "{meta: {n: 3}, data: [1, {id: 2, tags: [1, 2]}, 3]}";
+
+	json5_value_set_array (&items);
+	json5_coder_reset (coder);
+
+	assert (json5_coder_put_items (coder, (uint8_t const *) input, strlen (input), 0, decode_item, &items) == 0);
+	assert (json5_coder_put_items (coder, NULL, 0, 0, decode_item, &items) == 0);
+	assert (items.len == 4);
+	assert (items.items [0].type == JSON5_TYPE_OBJECT);
+	assert (items.items [1].type == JSON5_TYPE_ARRAY);
+	assert (items.items [1].len == 2);
+	assert (items.items [3].ival == 5);
+	assert (coder -> parser.value.type == JSON5_TYPE_ARRAY);
+	assert (coder -> parser.value.len == 0);
+
+	json5_value_set_null (&items);
+	json5_value_set_array (&items);
+	json5_coder_reset (coder);
+
+	assert (json5_coder_put_items (coder, (uint8_t const *) input2, strlen (input2), 1, decode_item, &items) == 0);
+	assert (json5_coder_put_items (coder, NULL, 0, 1, decode_item, &items) == 0);
+	assert (items.len == 3);
+	assert (items.items [1].type == JSON5_TYPE_OBJECT);
+	assert (json5_value_get_prop (&items.items [1], "tags", 4) -> len == 2);
+
+	data = json5_value_get_prop (&coder -> parser.value, "data", 4);
+	assert (data -> type == JSON5_TYPE_ARRAY);
+	assert (data -> len == 0);
+	assert (json5_value_get_prop (&coder -> parser.value, "meta", 4) -> type == JSON5_TYPE_OBJECT);
+
+	json5_value_set_null (&items);
+}
+
+static void test_step (json5_coder * coder) {
+	int res;
+	size_t calls;
+	json5_value value = JSON5_VALUE_INIT;
+	json5_coder_budget budget = {0};
+	char const * input = "{a: [1, 2, 3], b: 'four', c: {d: null}} // end";
+	uint8_t const * chars;
+	uint8_t const * end = (uint8_t const *) &input [strlen (input)];
+
+	// token budget
+	json5_coder_reset (coder);
+	budget.max_tokens = 2;
+	chars = (uint8_t const *) input;
+	calls = 0;
+
+	while ((res = json5_coder_decode_step (coder, &chars, end, 1, &budget)) == JSON5_CODER_CONTINUE) {
+		assert (json5_coder_take_value (coder, &value) != 0);
+		calls ++;
+	}
+
+	assert (res == 0);
+	assert (calls >= 10);
+	assert (chars == end);
+	assert (json5_coder_take_value (coder, &value) == 0);
+	assert (value.type == JSON5_TYPE_OBJECT);
+	assert (json5_value_get_prop (&value, "a", 1) -> len == 3);
+	assert (json5_value_get_prop (json5_value_get_prop (&value, "c", 1), "d", 1) -> type == JSON5_TYPE_NULL);
+
+	// byte budget with input arriving in chunks
+	json5_coder_reset (coder);
+	budget.max_tokens = 0;
+	budget.max_bytes = 3;
+	chars = (uint8_t const *) input;
+
+	for (size_t i = 0; i < strlen (input); i += 7) {
+		uint8_t const * chunk_end = (uint8_t const *) &input [i + 7 < strlen (input) ? i + 7 : strlen (input)];
+
+		while ((res = json5_coder_decode_step (coder, &chars, chunk_end, 0, &budget)) == JSON5_CODER_CONTINUE) {
+			assert (chars < chunk_end);
+		}
+
+		assert (res == 0);
+		assert (chars == chunk_end);
+	}
+
+	assert (json5_coder_decode_step (coder, &chars, end, 1, &budget) == 0);
+	assert (json5_coder_take_value (coder, &value) == 0);
+	assert (json5_value_get_prop (&value, "b", 1) -> type == JSON5_TYPE_STRING);
+
+	// time budget
+	json5_coder_reset (coder);
+	budget.max_bytes = 0;
+	budget.max_ns = 1;
+	chars = (uint8_t const *) input;
+
+	while ((res = json5_coder_decode_step (coder, &chars, end, 1, &budget)) == JSON5_CODER_CONTINUE) {
+	}
+
+	assert (res == 0);
+	assert (json5_coder_take_value (coder, &value) == 0);
+	assert (value.type == JSON5_TYPE_OBJECT);
+
+	// error
+	input = "[1, 2,, 3]";
+	end = (uint8_t const *) &input [strlen (input)];
+	json5_coder_reset (coder);
+	budget.max_ns = 0;
+	budget.max_tokens = 1;
+	chars = (uint8_t const *) input;
+
+	while ((res = json5_coder_decode_step (coder, &chars, end, 1, &budget)) == JSON5_CODER_CONTINUE) {
+	}
+
+	assert (res == -1);
+	assert (strstr (json5_coder_get_error (coder), "','") != NULL);
+	assert (json5_coder_take_value (coder, &value) != 0);
+
+	json5_value_set_null (&value);
+}
+
+static void test_into (json5_coder * coder) {
+	json5_value value = JSON5_VALUE_INIT;
+	json5_value * users, * name, * prop;
+	json5_value const * items;
+	json5_obj_itor itor;
+	char const * input;
+	char const * key;
+	size_t key_len;
+	char buf [16];
+	char * large;
+	size_t size = 0;
+
+	input = "{users: [{id: 1, name: 'alice'}, {id: 2, name: 'bob'}], count: 2}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	users = json5_value_get_prop (&value, "users", -1);
+	items = users -> items;
+	name = json5_value_get_prop (&users -> items [1], "name", -1);
+	assert (strcmp ((char const *) json5_value_get_string (name), "bob") == 0);
+
+	// same shape reuses storage
+	input = "{users: [{id: 3, name: 'carol'}, {id: 4, name: 'dan'}], count: 2}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (json5_value_get_prop (&value, "users", -1) == users);
+	assert (users -> items == items);
+	assert (json5_value_get_prop (&users -> items [1], "name", -1) == name);
+	assert (strcmp ((char const *) json5_value_get_string (name), "dan") == 0);
+	assert (json5_value_get_prop (&users -> items [0], "id", -1) -> ival == 3);
+
+	// removed items and properties
+	input = "{users: [{name: 'eve', admin: true}], total: 1}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 2);
+	assert (!json5_value_get_prop (&value, "count", -1));
+	assert (json5_value_get_prop (&value, "total", -1) -> ival == 1);
+
+	// removing properties moves the remaining ones
+	users = json5_value_get_prop (&value, "users", -1);
+	assert (users -> items == items);
+	assert (users -> len == 1);
+	assert (users -> items [0].len == 2);
+	assert (!json5_value_get_prop (&users -> items [0], "id", -1));
+	assert (json5_value_get_prop (&users -> items [0], "admin", -1) -> type == JSON5_TYPE_BOOL);
+
+	// duplicate keys and changed types
+	input = "{users: 'none', users: {a: [1, 2]}, total: 1, total: null}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 2);
+	assert (json5_value_get_prop (&value, "users", -1) -> type == JSON5_TYPE_OBJECT);
+	assert (json5_value_get_prop (&value, "total", -1) -> type == JSON5_TYPE_NULL);
+
+	// reused objects follow the document order
+	input = "{c: 4, users: null, d: 5, total: 6}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	for (int i = 0; i < 4; i ++) {
+		assert (json5_obj_itor_next (&itor, &key, &key_len, &prop));
+		assert (key [0] == "cudt" [i]);
+	}
+
+	assert (!json5_obj_itor_next (&itor, &key, &key_len, &prop));
+
+	// error leaves valid tree
+	input = "{users: {a: [1, 2, 3, ]]}}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (json5_coder_get_error (coder) != NULL);
+
+	// object growth
+	large = malloc (16 * 1000 + 2);
+	large [size ++] = '{';
+
+	for (int i = 0; i < 1000; i ++) {
+		size += sprintf (&large [size], "k%d: %d,", i, i);
+	}
+
+	large [size ++] = '}';
+
+	for (int n = 0; n < 2; n ++) {
+		assert (json5_coder_decode_into (coder, (uint8_t const *) large, size, &value) == 0);
+		assert (value.len == 1000);
+
+		for (int i = 0; i < 1000; i ++) {
+			snprintf (buf, sizeof (buf), "k%d", i);
+			assert ((prop = json5_value_get_prop (&value, buf, -1)) != NULL);
+			assert (prop -> ival == i);
+		}
+	}
+
+	// reversed order of an indexed object
+	size = 0;
+	large [size ++] = '{';
+
+	for (int i = 999; i >= 0; i --) {
+		size += sprintf (&large [size], "k%d: %d,", i, i);
+	}
+
+	large [size ++] = '}';
+	assert (json5_coder_decode_into (coder, (uint8_t const *) large, size, &value) == 0);
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	for (int i = 999; i >= 0; i --) {
+		assert (json5_obj_itor_next (&itor, &key, &key_len, &prop));
+		snprintf (buf, sizeof (buf), "k%d", i);
+		assert (strcmp (key, buf) == 0);
+		assert (json5_value_get_prop (&value, buf, -1) == prop);
+	}
+
+	free (large);
+	json5_value_set_null (&value);
+}
+
+static void test_limits (json5_coder * coder) {
+	json5_value value = JSON5_VALUE_INIT;
+	json5_limits limits = {0};
+	char const * input;
+	char * large;
+	size_t size = 100000;
+
+	// depth
+	limits.max_depth = 3;
+	json5_coder_set_limits (coder, &limits);
+
+	input = "[[[1]], {a: {b: 2}}]";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	input = "[[[[1]]]]";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "Maximum depth of 3") != NULL);
+
+	// values
+	limits.max_depth = 0;
+	limits.max_values = 4;
+	json5_coder_set_limits (coder, &limits);
+
+	input = "{a: 1, b: [2]}";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	input = "[1, 2, 3, 4]";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "Maximum number of 4 values") != NULL);
+
+	// string length
+	limits.max_values = 0;
+	limits.max_string_len = 5;
+	json5_coder_set_limits (coder, &limits);
+
+	input = "{abcde: 'abcde'}";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	input = "['abcdef']";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "maximum length of 5") != NULL);
+
+	input = "{abcdef: 1}";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+
+	// overlong string is rejected before it is buffered
+	large = malloc (size);
+	memset (large, 'x', size);
+	large [0] = '"';
+	limits.max_string_len = 1000;
+	json5_coder_set_limits (coder, &limits);
+	assert (json5_coder_decode (coder, (uint8_t const *) large, size, &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "maximum length of 1000") != NULL);
+	assert (coder -> tknzr.buffer_cap < size);
+
+	// size
+	limits.max_string_len = 0;
+	limits.max_bytes = 1000;
+	json5_coder_set_limits (coder, &limits);
+
+	input = "['abc', 'def']";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	large [size - 1] = '"';
+	assert (json5_coder_decode (coder, (uint8_t const *) large, size, &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "Maximum size of 1000 bytes") != NULL);
+
+	// no limits
+	json5_coder_set_limits (coder, NULL);
+	assert (json5_coder_decode (coder, (uint8_t const *) large, size, &value) == 0);
+	assert (value.len == size - 2);
+
+	free (large);
+	json5_value_set_null (&value);
+}
+
+static void test_dup_keys (json5_coder * coder) {
+	json5_value value = JSON5_VALUE_INIT;
+	json5_value * prop;
+	char const * input;
+
+	input = "{a: 1, b: [1, {c: 2}], a: {d: 3}, b: 'x'}";
+
+	// last wins
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 2);
+	assert (json5_value_get_prop (&value, "a", -1) -> type == JSON5_TYPE_OBJECT);
+	assert (strcmp ((char const *) json5_value_get_string (json5_value_get_prop (&value, "b", -1)), "x") == 0);
+
+	// error while a repeated key reuses the array of the first value
+	input = "{a: ['xxxxxxxxxxxxxxxxxxxxxxxx', 'yyyyyyyyyyyyyyyyyyyyyyy', {k: 'zzzzzzzzzzzzzzzzzzzz'}], a: [1, ";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+
+	input = "{a: 1, b: [1, {c: 2}], a: {d: 3}, b: 'x'}";
+
+	// first wins
+	json5_coder_set_dup_policy (coder, JSON5_DUP_FIRST);
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 2);
+	assert (json5_value_get_prop (&value, "a", -1) -> ival == 1);
+	prop = json5_value_get_prop (&value, "b", -1);
+	assert (prop -> type == JSON5_TYPE_ARRAY && prop -> len == 2);
+
+	// skipped values are validated
+	input = "{a: 1, a: [1, {b: }]}";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+
+	// reused objects
+	input = "{a: 1, b: 2}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	input = "{b: 5, b: 6, a: 7}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (json5_value_get_prop (&value, "a", -1) -> ival == 7);
+	assert (json5_value_get_prop (&value, "b", -1) -> ival == 5);
+
+	// reject
+	json5_coder_set_dup_policy (coder, JSON5_DUP_REJECT);
+	input = "{a: 1, b: 2}";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+
+	input = "{a: 1, b: {c: 2, 'c': 3}}";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) != 0);
+	assert (strstr (json5_coder_get_error (coder), "Duplicate key 'c'") != NULL);
+
+	// keys shared by sibling and nested reused objects
+	input = "[{id: 1, x: 'a'}, {id: 2, x: {id: 3}}]";
+
+	for (int i = 0; i < 2; i ++) {
+		json5_coder_set_dup_policy (coder, i ? JSON5_DUP_FIRST : JSON5_DUP_REJECT);
+		assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+		assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+		assert (value.len == 2);
+		assert (json5_value_get_prop (&value.items [0], "id", -1) -> ival == 1);
+		assert (json5_value_get_prop (&value.items [1], "id", -1) -> ival == 2);
+		prop = json5_value_get_prop (&value.items [1], "x", -1);
+		assert (json5_value_get_prop (prop, "id", -1) -> ival == 3);
+	}
+
+	json5_coder_set_dup_policy (coder, JSON5_DUP_LAST);
+	json5_value_set_null (&value);
+}
+
+static void test_keyset (json5_coder * coder) {
+	json5_value value = JSON5_VALUE_INIT;
+	json5_value * item;
+	json5_keyset keyset;
+	char const * keys [] = {"id", "name", "tags"};
+	char const * input;
+
+	assert (json5_keyset_init (&keyset, keys, 3) == 0);
+	json5_coder_set_keyset (coder, &keyset);
+
+	input = "[{id: 1, name: 'a'}, {id: 2, other: 3}, {tags: [{id: 4}], id: 3}]";
+	assert (json5_coder_decode (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 3);
+
+	item = &value.items [0];
+	assert (json5_value_get_key_id (item, &keyset, 0) -> ival == 1);
+	assert (strcmp ((char const *) json5_value_get_string (json5_value_get_prop (item, "name", -1)), "a") == 0);
+
+	item = &value.items [1];
+	assert (json5_value_get_key_id (item, &keyset, 0) -> ival == 2);
+	assert (json5_value_get_prop (item, "other", -1) -> ival == 3);
+
+	item = json5_value_get_key_id (&value.items [2], &keyset, 2);
+	assert (json5_value_get_key_id (&item -> items [0], &keyset, 0) -> ival == 4);
+
+	// reused objects keep their values array
+	input = "[{name: 'b', id: 5}, {id: 6}, {id: 7, more: true}]";
+	assert (json5_coder_decode_into (coder, (uint8_t const *) input, strlen (input), &value) == 0);
+	assert (value.len == 3);
+	assert (value.items [0].len == 2);
+	assert (json5_value_get_key_id (&value.items [0], &keyset, 0) -> ival == 5);
+	assert (value.items [1].len == 1);
+	assert (json5_value_get_prop (&value.items [1], "other", -1) == NULL);
+	assert (json5_value_get_key_id (&value.items [2], &keyset, 2) == NULL);
+	assert (json5_value_get_prop (&value.items [2], "more", -1) -> ival == 1);
+
+	json5_coder_set_keyset (coder, NULL);
+	json5_value_set_null (&value);
+	json5_keyset_destroy (&keyset);
+}
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+
+	assert (json5_coder_init (&coder) == 0);
+
+	test_docs (&coder);
+	test_items (&coder);
+	test_step (&coder);
+	test_into (&coder);
+	test_limits (&coder);
+	test_dup_keys (&coder);
+	test_keyset (&coder);
+
+	json5_coder_destroy (&coder);
+
+	return RESULT_PASS;
+}
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include "test.h"
+
+static void test_access (json5_coder * coder) {
+	json5_doc doc;
+	json5_doc_itor itor;
+	json5_value value = JSON5_VALUE_INIT;
+	size_t users, user, node, key, count;
+	uint8_t const * chars;
+	size_t len;
+	char const * input = "{users: [{name: 'Ann', id: 1}, {name: \"B\\u00f6b\", id: 2, 'x\\ty': -Infinity}], "
+		"n: 12345678901234567890, f: 2.5, ok: true, 'nil': null, a: 1, a: 2}";
+
+	assert (json5_doc_init (&doc) == 0);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) input, strlen (input)) == 0);
+
+	assert (json5_doc_get_type (&doc, 0) == JSON5_TYPE_OBJECT);
+	assert (json5_doc_get_len (&doc, 0) == 7);
+
+	users = json5_doc_get_prop (&doc, 0, "users", -1);
+	assert (users != JSON5_DOC_NONE);
+	assert (json5_doc_get_type (&doc, users) == JSON5_TYPE_ARRAY);
+	assert (json5_doc_get_len (&doc, users) == 2);
+	assert (json5_doc_get_item (&doc, users, 2) == JSON5_DOC_NONE);
+
+	user = json5_doc_get_item (&doc, users, 1);
+	node = json5_doc_get_prop (&doc, user, "name", -1);
+	chars = json5_doc_get_string (&doc, node, &len);
+	assert (len == 4 && memcmp (chars, "B\xc3\xb6" "b", 4) == 0);
+
+	node = json5_doc_get_prop (&doc, user, "x\ty", -1);
+	assert (json5_doc_get_type (&doc, node) == JSON5_TYPE_INFINITY);
+	assert (json5_doc_get_prop (&doc, user, "missing", -1) == JSON5_DOC_NONE);
+
+	assert (json5_doc_get_type (&doc, json5_doc_get_prop (&doc, 0, "n", -1)) == JSON5_TYPE_FLOAT);
+	assert (json5_doc_get_type (&doc, json5_doc_get_prop (&doc, 0, "ok", -1)) == JSON5_TYPE_BOOL);
+	assert (json5_doc_get_type (&doc, json5_doc_get_prop (&doc, 0, "nil", -1)) == JSON5_TYPE_NULL);
+
+	node = json5_doc_get_prop (&doc, 0, "f", -1);
+	assert (json5_doc_get_value (&doc, node, &value) == 0);
+	assert (value.type == JSON5_TYPE_FLOAT && value.fval == 2.5);
+
+	// repeated keys resolve to the last value
+	node = json5_doc_get_prop (&doc, 0, "a", -1);
+	assert (json5_doc_get_value (&doc, node, &value) == 0);
+	assert (value.type == JSON5_TYPE_INT && value.ival == 2);
+
+	// decode subtree
+	assert (json5_doc_get_value (&doc, user, &value) == 0);
+	assert (value.type == JSON5_TYPE_OBJECT && value.len == 3);
+
+	// iterate
+	assert (json5_doc_itor_init (&itor, &doc, users) == 0);
+	count = 0;
+
+	while (json5_doc_itor_next (&itor, &key, &node)) {
+		assert (key == JSON5_DOC_NONE);
+		assert (json5_doc_get_type (&doc, node) == JSON5_TYPE_OBJECT);
+		count ++;
+	}
+
+	assert (count == 2);
+	assert (json5_doc_itor_init (&itor, &doc, json5_doc_get_prop (&doc, 0, "f", -1)) != 0);
+
+	assert (json5_doc_itor_init (&itor, &doc, user) == 0);
+	assert (json5_doc_itor_next (&itor, &key, &node) == 1);
+	chars = json5_doc_get_string (&doc, key, &len);
+	assert (len == 4 && memcmp (chars, "name", 4) == 0);
+	assert (json5_doc_get_type (&doc, key) == JSON5_TYPE_STRING);
+
+	// invalid input
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) "{a: [1}", 7) != 0);
+	assert (json5_coder_get_error (coder) != NULL);
+	assert (json5_doc_get_type (&doc, 0) == JSON5_TYPE_NULL);
+
+	json5_value_set_null (&value);
+	json5_doc_destroy (&doc);
+}
+
+static void test_lookup_table (json5_coder * coder) {
+	json5_doc doc;
+	char * input = malloc (64 * 1000);
+	char key [16];
+	size_t size = 0;
+	size_t node;
+	json5_value value = JSON5_VALUE_INIT;
+
+	size += sprintf (&input [size], "{");
+
+	for (int i = 0; i < 1000; i ++) {
+		size += sprintf (&input [size], "k%d: %d, ", i, i);
+	}
+
+	size += sprintf (&input [size], "k5: -5}");
+
+	assert (json5_doc_init (&doc) == 0);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) input, size) == 0);
+
+	for (int i = 999; i >= 0; i --) {
+		node = json5_doc_get_prop (&doc, 0, key, sprintf (key, "k%d", i));
+		assert (json5_doc_get_value (&doc, node, &value) == 0);
+		assert (value.ival == (i == 5 ? -5 : i));
+	}
+
+	assert (json5_doc_get_prop (&doc, 0, "k1000", -1) == JSON5_DOC_NONE);
+
+	// first value with `JSON5_DUP_FIRST`
+	json5_coder_set_dup_policy (coder, JSON5_DUP_FIRST);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) input, size) == 0);
+	node = json5_doc_get_prop (&doc, 0, "k5", -1);
+	assert (json5_doc_get_value (&doc, node, &value) == 0);
+	assert (value.ival == 5);
+
+	// rejected like `json5_coder_decode`
+	json5_coder_set_dup_policy (coder, JSON5_DUP_REJECT);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) input, size) != 0);
+	assert (strstr (json5_coder_get_error (coder), "Duplicate key 'k5'") != NULL);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) "{a: 1, b: {a: 2}}", 17) == 0);
+	assert (json5_doc_get_prop (&doc, 0, "b", -1) != JSON5_DOC_NONE);
+	json5_coder_set_dup_policy (coder, JSON5_DUP_LAST);
+
+	json5_value_set_null (&value);
+	json5_doc_destroy (&doc);
+	free (input);
+}
+
+static void test_limits (json5_coder * coder) {
+	json5_doc doc;
+	json5_limits limits = {.max_depth = 2};
+
+	assert (json5_doc_init (&doc) == 0);
+	json5_coder_set_limits (coder, &limits);
+
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) "[[1]]", 5) == 0);
+	assert (json5_doc_decode (&doc, coder, (uint8_t const *) "[[[1]]]", 7) != 0);
+	assert (strstr (json5_coder_get_error (coder), "depth") != NULL);
+
+	json5_coder_set_limits (coder, NULL);
+	json5_doc_destroy (&doc);
+}
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+
+	assert (json5_coder_init (&coder) == 0);
+
+	test_access (&coder);
+	test_lookup_table (&coder);
+	test_limits (&coder);
+
+	json5_coder_destroy (&coder);
+
+	return RESULT_PASS;
+}
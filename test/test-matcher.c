@@ -0,0 +1,72 @@
+#include "test.h"
+
+static int count;
+
+static int match_func (size_t path, json5_value * value, void * arg) {
+	if (path == 0) {
+		assert (value -> type == JSON5_TYPE_INT);
+		assert (value -> ival == 7);
+	}
+	else if (path == 1) {
+		assert (value -> type == JSON5_TYPE_FLOAT);
+	}
+	else {
+		assert (value -> type == JSON5_TYPE_ARRAY);
+	}
+
+	count ++;
+
+	return 0;
+}
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+	json5_matcher matcher;
+	json5_value result = JSON5_VALUE_INIT;
+	json5_value * item;
+	char const * input = "{user: {id: 7, name: 'abc'}, items: [{price: 1.5}, {price: 2.5, x: [1, 2]}], meta: {ts: [1, {a: 2}]}}";
+
+	assert (json5_coder_init (&coder) == 0);
+	assert (json5_matcher_init (&matcher) == 0);
+
+	assert (json5_matcher_add_path (&matcher, "user.id", -1) == 0);
+	assert (json5_matcher_add_path (&matcher, "items[*].price", -1) == 1);
+	assert (json5_matcher_add_path (&matcher, "meta.ts", -1) == 2);
+	assert (json5_matcher_add_path (&matcher, "missing[0]", -1) == 3);
+	assert (json5_matcher_add_path (&matcher, "user..id", -1) == -1);
+	assert (json5_matcher_add_path (&matcher, "user[x]", -1) == -1);
+
+	assert (json5_matcher_match (&matcher, &coder, (uint8_t const *) input, strlen (input), &result) == 0);
+	assert (result.type == JSON5_TYPE_OBJECT);
+
+	item = json5_value_get_prop (&result, "user.id", -1);
+	assert (item != NULL);
+	assert (item -> type == JSON5_TYPE_INT);
+	assert (item -> ival == 7);
+
+	item = json5_value_get_prop (&result, "items[*].price", -1);
+	assert (item != NULL);
+	assert (item -> type == JSON5_TYPE_ARRAY);
+	assert (item -> len == 2);
+	assert (item -> items [1].fval == 2.5);
+
+	item = json5_value_get_prop (&result, "meta.ts", -1);
+	assert (item != NULL);
+	assert (item -> type == JSON5_TYPE_ARRAY);
+	assert (item -> len == 2);
+	assert (json5_value_get_prop (&item -> items [1], "a", 1) -> ival == 2);
+
+	assert (json5_value_get_prop (&result, "missing[0]", -1) == NULL);
+
+	json5_matcher_set_func (&matcher, match_func, NULL);
+	assert (json5_matcher_match (&matcher, &coder, (uint8_t const *) input, strlen (input), NULL) == 0);
+	assert (count == 4);
+
+	assert (json5_matcher_match (&matcher, &coder, (uint8_t const *) "{user: }", 8, NULL) != 0);
+
+	json5_value_set_null (&result);
+	json5_matcher_destroy (&matcher);
+	json5_coder_destroy (&coder);
+
+	return RESULT_PASS;
+}
@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include "test.h"
+
+#define COUNT 40000
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+	json5_value value1 = JSON5_VALUE_INIT;
+	json5_value value2 = JSON5_VALUE_INIT;
+	json5_value * item1;
+	json5_value * item2;
+	char * input;
+	char error [256];
+	size_t size = 0;
+
+	assert (json5_coder_init (&coder) == 0);
+
+	input = malloc (COUNT * 128);
+	size += sprintf (&input [size], "/* [ */ [\n");
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		size += sprintf (&input [size], "{id: %zu, s: 'a, \\'b]', t: [1, \"],\"], /* , */ u: {v: null}}, // ,[\n", i);
+	}
+
+	size += sprintf (&input [size], "] // end");
+
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) == 0);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) == 0);
+
+	assert (value2.type == JSON5_TYPE_ARRAY);
+	assert (value2.len == value1.len);
+	assert (value2.len == COUNT);
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		item1 = &value1.items [i];
+		item2 = &value2.items [i];
+
+		assert (json5_value_get_prop (item2, "id", 2) -> ival == (int64_t) i);
+		assert (strcmp ((char const *) json5_value_get_string (json5_value_get_prop (item2, "s", 1)), "a, 'b]") == 0);
+		assert (json5_value_get_prop (item2, "t", 1) -> len == 2);
+		assert (json5_value_get_prop (json5_value_get_prop (item2, "u", 1), "v", 1) -> type == JSON5_TYPE_NULL);
+		assert (item2 -> len == item1 -> len);
+	}
+
+	// error in a later range
+	memcpy (strstr (input, "{id: 23456,"), "{id: 23456:", 11);
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) != 0);
+	snprintf (error, sizeof (error), "%s", json5_coder_get_error (&coder));
+	assert (strcmp (error, "Unexpected ':' on line 23458:11") == 0);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) != 0);
+	assert (strcmp (json5_coder_get_error (&coder), error) == 0);
+	memcpy (strstr (input, "{id: 23456:"), "{id: 23456,", 11);
+
+	// limits apply to all ranges
+	json5_limits limits = {.max_depth = 2};
+
+	json5_coder_set_limits (&coder, &limits);
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) != 0);
+	snprintf (error, sizeof (error), "%s", json5_coder_get_error (&coder));
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) != 0);
+	assert (strcmp (json5_coder_get_error (&coder), error) == 0);
+
+	// every item has 8 values
+	limits = (json5_limits) {.max_values = COUNT * 8 + 1};
+	json5_coder_set_limits (&coder, &limits);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) == 0);
+
+	limits.max_values --;
+	json5_coder_set_limits (&coder, &limits);
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) != 0);
+	snprintf (error, sizeof (error), "%s", json5_coder_get_error (&coder));
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) != 0);
+	assert (strcmp (json5_coder_get_error (&coder), error) == 0);
+
+	json5_coder_set_limits (&coder, NULL);
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) == 0);
+	limits = (json5_limits) {.max_bytes = coder.parser.bytes};
+	json5_coder_set_limits (&coder, &limits);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) == 0);
+
+	limits.max_bytes --;
+	json5_coder_set_limits (&coder, &limits);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) != 0);
+	assert (strstr (json5_coder_get_error (&coder), "Maximum size of") != NULL);
+	json5_coder_set_limits (&coder, NULL);
+
+	// duplicate key policy and key set are used by all ranges
+	char const * keys [] = {"u", "t", "s", "id"};
+	json5_keyset keyset;
+	json5_obj_itor itor;
+	char const * key;
+	size_t key_len;
+
+	memcpy (strstr (input, "{id: 34567, s: "), "{id: 34567, id:", 15);
+	json5_coder_set_dup_policy (&coder, JSON5_DUP_REJECT);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) != 0);
+	assert (strstr (json5_coder_get_error (&coder), "Duplicate key 'id' on line 34569") != NULL);
+	json5_coder_set_dup_policy (&coder, JSON5_DUP_FIRST);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) == 0);
+	assert (json5_value_get_prop (&value2.items [34567], "id", 2) -> ival == 34567);
+	json5_coder_set_dup_policy (&coder, JSON5_DUP_LAST);
+	memcpy (strstr (input, "{id: 34567, id:"), "{id: 34567, s: ", 15);
+
+	assert (json5_keyset_init (&keyset, keys, 4) == 0);
+	json5_coder_set_keyset (&coder, &keyset);
+	assert (json5_parallel_decode (&coder, (uint8_t const *) input, size, 4, &value2) == 0);
+	assert (json5_obj_itor_init (&itor, &value2.items [COUNT - 1]) == 0);
+	assert (json5_obj_itor_next (&itor, &key, &key_len, &item2) == 1);
+	assert (strcmp (key, "u") == 0);
+	json5_coder_set_keyset (&coder, NULL);
+	json5_value_set_null (&value2);
+	json5_keyset_destroy (&keyset);
+
+	// not an array
+	assert (json5_parallel_decode (&coder, (uint8_t const *) "{a: [1, 2]}", 11, 4, &value2) == 0);
+	assert (value2.type == JSON5_TYPE_OBJECT);
+
+	json5_value_set_null (&value1);
+	json5_value_set_null (&value2);
+	json5_coder_destroy (&coder);
+	free (input);
+
+	return RESULT_PASS;
+}
@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include "test.h"
+
+#define COUNT 20000
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+	json5_value value1 = JSON5_VALUE_INIT;
+	json5_value value2 = JSON5_VALUE_INIT;
+	json5_value * item;
+	char * input;
+	char name [32];
+	size_t size = 0;
+
+	assert (json5_coder_init (&coder) == 0);
+
+	input = malloc (COUNT * 128);
+	size += sprintf (&input [size], "[\n");
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		size += sprintf (&input [size], "{id: %zu, name: 'item \\'%zu\\'', tags: ['a', \"b\"], x: %zu.5}, // c\n", i, i, i);
+	}
+
+	size += sprintf (&input [size], "]");
+	assert (size >= JSON5_PIPELINE_MIN_SIZE);
+
+	assert (json5_coder_decode (&coder, (uint8_t const *) input, size, &value1) == 0);
+	assert (json5_pipeline_decode (&coder, (uint8_t const *) input, size, &value2) == 0);
+
+	assert (value2.type == JSON5_TYPE_ARRAY);
+	assert (value2.len == value1.len);
+	assert (value2.len == COUNT);
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		item = &value2.items [i];
+		snprintf (name, sizeof (name), "item '%zu'", i);
+
+		assert (item -> len == value1.items [i].len);
+		assert (json5_value_get_prop (item, "id", 2) -> ival == (int64_t) i);
+		assert (strcmp ((char const *) json5_value_get_string (json5_value_get_prop (item, "name", 4)), name) == 0);
+		assert (json5_value_get_prop (item, "tags", 4) -> len == 2);
+		assert (json5_value_get_prop (item, "x", 1) -> fval == i + 0.5);
+	}
+
+	// syntax error near the end
+	input [size - 1] = ':';
+	assert (json5_pipeline_decode (&coder, (uint8_t const *) input, size, &value2) != 0);
+	assert (strstr (json5_coder_get_error (&coder), "Unexpected ':' on line 20002") != NULL);
+
+	// tokenizer error at the start
+	input [0] = '#';
+	assert (json5_pipeline_decode (&coder, (uint8_t const *) input, size, &value2) != 0);
+	assert (json5_coder_get_error (&coder) != NULL);
+
+	json5_value_set_null (&value1);
+	json5_value_set_null (&value2);
+	json5_coder_destroy (&coder);
+	free (input);
+
+	return RESULT_PASS;
+}
@@ -0,0 +1,106 @@
+#include "test.h"
+
+static json5_event_type const expected [] = {
+	JSON5_EVENT_BEGIN_OBJ,
+	JSON5_EVENT_KEY,
+	JSON5_EVENT_BEGIN_ARR,
+	JSON5_EVENT_VALUE,
+	JSON5_EVENT_VALUE,
+	JSON5_EVENT_BEGIN_OBJ,
+	JSON5_EVENT_KEY,
+	JSON5_EVENT_VALUE,
+	JSON5_EVENT_END_OBJ,
+	JSON5_EVENT_END_ARR,
+	JSON5_EVENT_KEY,
+	JSON5_EVENT_VALUE,
+	JSON5_EVENT_END_OBJ,
+	JSON5_EVENT_END,
+};
+
+int main (int argc, char const * argv []) {
+	json5_reader reader;
+	json5_event event;
+	size_t count = 0;
+	size_t pos = 0;
+	int res;
+	char const * input = "{a: [1, 2.5, {b: 'xyz'},], c: null, // comment\n}";
+	size_t size = strlen (input);
+
+	assert (json5_reader_init (&reader) == 0);
+
+	// feed in chunks of 3 chars
+	for (;;) {
+		res = json5_reader_next (&reader, &event);
+		assert (res >= 0);
+
+		if (res == 0) {
+			if (event.type == JSON5_EVENT_END && count) {
+				break;
+			}
+
+			if (pos < size) {
+				size_t chunk = size - pos < 3 ? size - pos : 3;
+
+				json5_reader_put_chars (&reader, (uint8_t const *) &input [pos], chunk);
+				pos += chunk;
+			}
+			else {
+				json5_reader_put_chars (&reader, NULL, 0);
+			}
+
+			continue;
+		}
+
+		assert (count < sizeof (expected) / sizeof (*expected));
+		assert (event.type == expected [count]);
+
+		if (count == 6) {
+			assert (event.depth == 3);
+			assert (event.token -> length == 1);
+			assert (event.token -> token [0] == 'b');
+		}
+		else if (count == 4) {
+			assert (event.token -> type == JSON5_TOK_NUMBER_FLOAT);
+			assert (event.token -> value.f == 2.5);
+		}
+
+		count ++;
+	}
+
+	assert (count == sizeof (expected) / sizeof (*expected));
+
+	// skip container
+	json5_reader_reset (&reader);
+	input = "{a: [1, [2, {x: 3}]], b: 4}";
+	json5_reader_put_chars (&reader, (uint8_t const *) input, strlen (input));
+	json5_reader_put_chars (&reader, NULL, 0);
+
+	assert (json5_reader_next (&reader, &event) == 1);
+	assert (json5_reader_next (&reader, &event) == 1);
+	assert (event.type == JSON5_EVENT_KEY);
+	assert (json5_reader_next (&reader, &event) == 1);
+	assert (event.type == JSON5_EVENT_BEGIN_ARR);
+	assert (json5_reader_skip (&reader, &event) == 1);
+	assert (json5_reader_next (&reader, &event) == 1);
+	assert (event.type == JSON5_EVENT_KEY);
+	assert (event.token -> token [0] == 'b');
+	assert (json5_reader_next (&reader, &event) == 1);
+	assert (event.token -> value.i == 4);
+
+	// syntax error
+	json5_reader_reset (&reader);
+	input = "[1, 2\n: 3]";
+	json5_reader_put_chars (&reader, (uint8_t const *) input, strlen (input));
+	json5_reader_put_chars (&reader, NULL, 0);
+
+	while ((res = json5_reader_next (&reader, &event)) > 0) {
+		;
+	}
+
+	assert (res == -1);
+	assert (strcmp (json5_reader_get_error (&reader), "Unexpected ':' on line 2:1") == 0);
+
+	json5_reader_destroy (&reader);
+
+	return RESULT_PASS;
+}
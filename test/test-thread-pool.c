@@ -0,0 +1,78 @@
+#include <stdlib.h>
+#include "test.h"
+
+#define COUNT 1000
+
+int main (int argc, char const * argv []) {
+	json5_thread_pool * pool;
+	uint8_t const * inputs [COUNT];
+	size_t lens [COUNT];
+	json5_value outs [COUNT];
+	int results [COUNT];
+	char * strings [COUNT];
+	char * large;
+	size_t size;
+
+	assert ((pool = json5_thread_pool_create (4)) != NULL);
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		strings [i] = malloc (64);
+		size = snprintf (strings [i], 64, "{id: %zu, tags: ['a', 'b']}", i);
+		inputs [i] = (uint8_t const *) strings [i];
+		lens [i] = size;
+		outs [i] = JSON5_VALUE_INIT;
+	}
+
+	// a few large inputs
+	size = 1 << 20;
+	large = malloc (size);
+	large [0] = '[';
+
+	for (size_t i = 1; i < size - 1; i += 2) {
+		large [i] = '1';
+		large [i + 1] = ',';
+	}
+
+	large [size - 1] = ']';
+
+	for (size_t i = 0; i < 3; i ++) {
+		inputs [i] = (uint8_t const *) large;
+		lens [i] = size;
+	}
+
+	// invalid input
+	inputs [500] = (uint8_t const *) "{a: }";
+	lens [500] = 5;
+
+	assert (json5_decode_batch (inputs, lens, COUNT, outs, pool, results) == 1);
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		if (i < 3) {
+			assert (results [i] == 0);
+			assert (outs [i].type == JSON5_TYPE_ARRAY);
+			assert (outs [i].len == (size - 1) / 2);
+		}
+		else if (i == 500) {
+			assert (results [i] == -1);
+			assert (outs [i].type == JSON5_TYPE_NULL);
+		}
+		else {
+			assert (results [i] == 0);
+			assert (json5_value_get_prop (&outs [i], "id", 2) -> ival == (int64_t) i);
+		}
+	}
+
+	// reuse pool
+	assert (json5_decode_batch (&inputs [3], &lens [3], 10, &outs [3], pool, NULL) == 0);
+	assert (json5_value_get_prop (&outs [12], "id", 2) -> ival == 12);
+
+	for (size_t i = 0; i < COUNT; i ++) {
+		json5_value_set_null (&outs [i]);
+		free (strings [i]);
+	}
+
+	free (large);
+	json5_thread_pool_destroy (pool);
+
+	return RESULT_PASS;
+}
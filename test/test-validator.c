@@ -0,0 +1,75 @@
+#include "test.h"
+
+static char const * const valid [] = {
+	"{a: [1, 2.5, {b: 'xyz'},], c: null, // comment\n}",
+	"[true, false, null, NaN, -Infinity, +.5, 5., 0x1F, 1e-3, 'a\\\n b']",
+	"{'x': \"\\u00e4\\x41\\ud83d\\ude00\", true: 1, /* c */ Infinity: 2}",
+	"  \"\xc3\xa4\" // \xc3\xa4",
+	"[[[[[]]]]]",
+	"['', \xc2\xa0null]",
+};
+
+static char const * const invalid [] = {
+	"",
+	"{a: 1",
+	"[1 2]",
+	"{a 1}",
+	"{1: 2}",
+	"[1,,]",
+	"'abc",
+	"'\\u12'",
+	"'\\u12",
+	"'\\ud83d'",
+	"0x",
+	"01x2",
+	"1e",
+	"-true",
+	"nul",
+	"[1] 2",
+	"/ 1",
+	"1 /* x",
+	"'\xc3'",
+};
+
+int main (int argc, char const * argv []) {
+	json5_coder coder;
+	json5_value value = JSON5_VALUE_INIT;
+	json5_validate_error error;
+	char deep [1200];
+
+	assert (json5_coder_init (&coder) == 0);
+
+	for (size_t i = 0; i < sizeof (valid) / sizeof (*valid); i ++) {
+		size_t size = strlen (valid [i]);
+
+		assert (json5_validate ((uint8_t const *) valid [i], size, &error) == 0);
+		assert (json5_coder_decode (&coder, (uint8_t const *) valid [i], size, &value) == 0);
+	}
+
+	for (size_t i = 0; i < sizeof (invalid) / sizeof (*invalid); i ++) {
+		size_t size = strlen (invalid [i]);
+
+		assert (json5_validate ((uint8_t const *) invalid [i], size, &error) != 0);
+		assert (error.message != NULL);
+		assert (json5_coder_decode (&coder, (uint8_t const *) invalid [i], size, &value) != 0);
+	}
+
+	// error position
+	assert (json5_validate ((uint8_t const *) "{\n  a: 1,\n  b 2}", 16, &error) != 0);
+	assert (error.offset == 14);
+	assert (error.lineno == 3);
+	assert (error.colno == 5);
+
+	assert (json5_validate ((uint8_t const *) "[1]", 3, NULL) == 0);
+
+	// nesting deeper than the initial stack
+	memset (deep, '[', 600);
+	memset (&deep [600], ']', 600);
+	assert (json5_validate ((uint8_t const *) deep, sizeof (deep), &error) == 0);
+	assert (json5_validate ((uint8_t const *) deep, sizeof (deep) - 1, &error) != 0);
+
+	json5_value_set_null (&value);
+	json5_coder_destroy (&coder);
+
+	return RESULT_PASS;
+}
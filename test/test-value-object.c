@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "test.h"
 
 int main (int argc, char const * argv []) {
@@ -49,5 +50,307 @@ int main (int argc, char const * argv []) {
 	assert (json5_value_delete_prop (&value, "somkey44", 8) == 1);
 	assert (value.len == 0);
 
+	// interned keys are shared between objects
+	json5_key_table table = {0};
+	json5_value other = JSON5_VALUE_INIT;
+	json5_obj_prop * prop;
+	json5_obj_prop * prop2;
+	int exists;
+
+	json5_value_set_object (&other);
+
+	prop = json5_value_intern_prop (&value, &table, "timestamp", -1, &exists);
+	assert (prop != NULL);
+	assert (exists == 0);
+
+	prop2 = json5_value_intern_prop (&other, &table, "timestamp", 9, &exists);
+	assert (prop2 != NULL);
+	assert (exists == 0);
+	assert (prop2 -> key == prop -> key);
+
+	prop2 = json5_value_intern_prop (&other, &table, "timestamp", 9, &exists);
+	assert (exists == 1);
+	assert (other.len == 1);
+
+	// keys stay valid after the table is released
+	json5_key_table_destroy (&table);
+	json5_value_set_null (&value);
+
+	assert (json5_value_get_prop (&other, "timestamp", -1) == &prop2 -> value);
+	assert (strcmp ((char const *) prop2 -> key, "timestamp") == 0);
+
+	json5_value_set_null (&other);
+
+	// properties are iterated in insertion order
+	json5_obj_itor itor;
+	char const * key;
+	size_t key_len;
+	char name [32];
+
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 1000; i ++) {
+		snprintf (name, sizeof (name), "%d", 999 - i);
+		json5_value_set_int (json5_value_set_prop (&value, name, -1, 0), i);
+
+		// delete every third property while growing
+		if (i % 3 == 2) {
+			snprintf (name, sizeof (name), "%d", 999 - i + 1);
+			assert (json5_value_delete_prop (&value, name, -1) == 1);
+		}
+	}
+
+	assert (value.len == 667);
+	assert (json5_value_get_prop (&value, "998", -1) == NULL);
+	assert (json5_value_get_prop (&value, "997", -1) -> ival == 2);
+
+	int last = -1;
+	int count = 0;
+
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	while (json5_obj_itor_next (&itor, &key, &key_len, &item)) {
+		assert (item -> ival > last);
+		assert (item -> ival % 3 != 1);
+		assert (atoi (key) == 999 - item -> ival);
+		last = item -> ival;
+		count ++;
+	}
+
+	assert (count == 667);
+
+	json5_value_set_null (&value);
+
+	// small objects keep their order when deleting and growing past the
+	// linear search limit
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 8; i ++) {
+		snprintf (name, sizeof (name), "k%d", i);
+		json5_value_set_int (json5_value_set_prop (&value, name, -1, 0), i);
+	}
+
+	assert (json5_value_delete_prop (&value, "k2", -1) == 1);
+	assert (json5_value_delete_prop (&value, "k2", -1) == 0);
+	assert (json5_value_get_prop (&value, "k7", -1) -> ival == 7);
+
+	for (int i = 8; i < 12; i ++) {
+		snprintf (name, sizeof (name), "k%d", i);
+		json5_value_set_int (json5_value_set_prop (&value, name, -1, 0), i);
+	}
+
+	assert (value.len == 11);
+	assert (json5_value_get_prop (&value, "k3", -1) -> ival == 3);
+	assert (json5_value_get_prop (&value, "k11", -1) -> ival == 11);
+
+	last = -1;
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	while (json5_obj_itor_next (&itor, &key, &key_len, &item)) {
+		assert (item -> ival > last && item -> ival != 2);
+		last = item -> ival;
+	}
+
+	assert (last == 11);
+
+	json5_value_set_null (&value);
+
+	// deleted properties are reclaimed while inserting and deleting
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 20000; i ++) {
+		snprintf (name, sizeof (name), "s%d", i);
+		json5_value_set_int (json5_value_set_prop (&value, name, -1, 0), i);
+
+		if (i >= 100) {
+			snprintf (name, sizeof (name), "s%d", i - 100);
+			assert (json5_value_delete_prop (&value, name, -1) == 1);
+		}
+	}
+
+	assert (value.len == 100);
+	assert (json5_value_get_prop (&value, "s19899", -1) == NULL);
+	assert (json5_value_get_prop (&value, "s19900", -1) -> ival == 19900);
+	assert (json5_value_get_prop (&value, "s19999", -1) -> ival == 19999);
+
+	last = 19899;
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	while (json5_obj_itor_next (&itor, &key, &key_len, &item)) {
+		assert (item -> ival == last + 1);
+		last = item -> ival;
+	}
+
+	assert (last == 19999);
+
+	json5_value_set_null (&value);
+
+	// large objects move properties while inserting
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 100000; i ++) {
+		snprintf (name, sizeof (name), "m%d", i);
+		json5_value_set_int (json5_value_set_prop (&value, name, -1, 0), i);
+		assert (json5_value_get_prop (&value, "m0", -1) -> ival == 0);
+		assert (json5_value_get_prop (&value, name, -1) -> ival == i);
+
+		if (i % 10 == 9) {
+			snprintf (name, sizeof (name), "m%d", i / 2);
+			assert (json5_value_delete_prop (&value, name, -1) == 1);
+		}
+	}
+
+	assert (json5_value_get_prop (&value, "m99998", -1) -> ival == 99998);
+	assert (json5_value_get_prop (&value, "m4", -1) == NULL);
+	assert (value.len == 90000);
+
+	last = -1;
+	count = 0;
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	while (json5_obj_itor_next (&itor, &key, &key_len, &item)) {
+		assert (item -> ival > last);
+		assert (atoi (key + 1) == item -> ival);
+		last = item -> ival;
+		count ++;
+	}
+
+	assert ((unsigned) count == value.len);
+
+	json5_value_set_null (&value);
+
+	// precomputed keys and paths
+	json5_key ts_key;
+	json5_path path = {0};
+
+	json5_key_init (&ts_key, "timestamp", -1);
+	json5_value_set_object (&value);
+
+	item = json5_value_set_prop (&value, "events", -1, 0);
+	json5_value_set_array (item);
+
+	for (int i = 0; i < 20; i ++) {
+		item2 = json5_value_append_item (item);
+		json5_value_set_object (item2);
+		json5_value_set_int (json5_value_set_prop (item2, "timestamp", -1, 0), 1000 + i);
+
+		// grow some objects past the linear search limit
+		for (int j = 0; j < i; j ++) {
+			snprintf (name, sizeof (name), "f%d", j);
+			json5_value_set_prop (item2, name, -1, 0);
+		}
+	}
+
+	for (int i = 0; i < 20; i ++) {
+		assert (json5_value_get_key (&value.props [0].value.items [i], &ts_key) -> ival == 1000 + i);
+	}
+
+	assert (json5_path_append_key (&path, "events", -1) == 0);
+	assert (json5_path_append_index (&path, 15) == 0);
+	assert (json5_path_append_key (&path, "timestamp", 9) == 0);
+	assert (json5_value_get_path (&value, &path) -> ival == 1015);
+
+	path.items [1].index = 20;
+	assert (json5_value_get_path (&value, &path) == NULL);
+
+	json5_path_destroy (&path);
+	assert (json5_path_append_index (&path, 0) == 0);
+	assert (json5_value_get_path (&value, &path) == NULL);
+	json5_path_destroy (&path);
+
+	json5_value_set_null (&value);
+
+	// objects of a key set store values by key ID
+	char const * fields [] = {"id", "name", "tags", "created", "updated"};
+	char const * dups [] = {"id", "name", "id"};
+	json5_keyset keyset;
+	json5_keyset dup_set;
+
+	assert (json5_keyset_init (&dup_set, dups, 3) != 0);
+	assert (json5_keyset_init (&keyset, fields, 5) == 0);
+	assert (json5_keyset_find (&keyset, "tags", -1) == 2);
+	assert (json5_keyset_find (&keyset, "tag", -1) == -1);
+
+	json5_value_set_object (&value);
+	json5_value_set_int (json5_value_set_prop (&value, "updated", -1, 0), 4);
+	json5_value_set_int (json5_value_set_prop (&value, "id", -1, 0), 0);
+	json5_value_set_int (json5_value_set_prop (&value, "name", -1, 0), 1);
+
+	assert (json5_value_use_keyset (&value, &keyset) == 1);
+	assert (json5_value_use_keyset (&value, &keyset) == 1);
+	assert (value.len == 3);
+	assert (json5_value_get_key_id (&value, &keyset, 4) -> ival == 4);
+	assert (json5_value_get_key_id (&value, &keyset, 2) == NULL);
+	assert (json5_value_get_prop (&value, "name", -1) -> ival == 1);
+	assert (json5_value_get_prop (&value, "nam", -1) == NULL);
+	assert (json5_value_get_key (&value, &ts_key) == NULL);
+
+	// existing keys are set without converting
+	json5_value_set_int (json5_value_set_prop (&value, "tags", -1, 0), 2);
+	assert (json5_value_get_key_id (&value, &keyset, 2) -> ival == 2);
+	assert (json5_value_set_prop (&value, "tags", -1, 0) == NULL);
+	assert (json5_value_delete_prop (&value, "id", -1) == 1);
+	assert (json5_value_delete_prop (&value, "id", -1) == 0);
+	assert (value.len == 3);
+
+	last = -1;
+	assert (json5_obj_itor_init (&itor, &value) == 0);
+
+	while (json5_obj_itor_next (&itor, &key, &key_len, &item)) {
+		assert (item -> ival > last);
+		assert (strcmp (key, fields [item -> ival]) == 0);
+		last = item -> ival;
+	}
+
+	assert (last == 4);
+
+	// other keys convert the object back to a property table
+	json5_value_set_int (json5_value_set_prop (&value, "extra", -1, 0), 5);
+	assert (value.len == 4);
+	assert (json5_value_get_key_id (&value, &keyset, 1) -> ival == 1);
+	assert (json5_value_get_prop (&value, "extra", -1) -> ival == 5);
+	assert (json5_value_use_keyset (&value, &keyset) == 0);
+
+	json5_value_set_null (&value);
+	json5_keyset_destroy (&keyset);
+
+	// keys are hashed again if the seed changed
+	json5_set_hash_seed (0x2545F4914F6CDD1DULL);
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 20; i ++) {
+		snprintf (name, sizeof (name), "f%d", i);
+		json5_value_set_prop (&value, name, -1, 0);
+	}
+
+	json5_value_set_int (json5_value_set_prop (&value, "timestamp", -1, 0), 1019);
+	assert (json5_value_get_key (&value, &ts_key) -> ival == 1019);
+
+	json5_value_set_null (&value);
+
+	// bytes >= 0x80 are hashed unsigned
+	assert (json5_hash_key ("\xc3\xa4", -1) == json5_hash_key ("\xc3\xa4\xff", 2));
+	assert (json5_hash_key ("\xc3\xa4", 2) != json5_hash_key ("\xc3\xa5", 2));
+	assert (json5_hash_fast ("\xff", 1, 0) != json5_hash_fast ("\x7f", 1, 0));
+
+	// use keyed hash for untrusted input
+	json5_set_hash_func (JSON5_HASH_SIP);
+	json5_set_hash_seed (0x8A0C7C3E4B1D22F5ULL);
+	json5_value_set_object (&value);
+
+	for (int i = 0; i < 200; i ++) {
+		snprintf (name, sizeof (name), "key-\xe2\x82\xac-%d", i);
+		item = json5_value_set_prop (&value, name, -1, 0);
+		assert (item != NULL);
+		json5_value_set_int (item, i);
+	}
+
+	assert (value.len == 200);
+	assert (json5_value_get_prop (&value, "key-\xe2\x82\xac-123", -1) -> ival == 123);
+	assert (json5_value_get_prop (&value, "key-\xe2\x82\xac-200", -1) == NULL);
+
+	json5_value_set_null (&value);
+	json5_set_hash_func (JSON5_HASH_FAST);
+
 	return RESULT_PASS;
 }
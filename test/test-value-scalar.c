@@ -33,7 +33,33 @@ int main (int argc, char const * argv []) {
 	json5_value_set_string (&value, "akey2", 5);
 	assert (value.type == JSON5_TYPE_STRING);
 	assert (value.len == 5);
-	assert (strcmp ((void *) value.sval, "akey2") == 0);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "akey2") == 0);
+
+	// switch between inline and allocated storage
+	json5_value_set_string (&value, "a longer string value", -1);
+	assert (value.len == 21);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "a longer string value") == 0);
+
+	json5_value_set_string (&value, (char const *) json5_value_get_string (&value) + 2, 6);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "longer") == 0);
+	assert (json5_value_get_string (&value) == value.chars);
+
+	json5_value_set_string (&value, "eight ch", -1);
+	assert (value.len == 8);
+	assert (json5_value_get_string (&value) == value.sval);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "eight ch") == 0);
+
+	json5_value_set_string (&value, "seven c", -1);
+	assert (value.len == 7);
+	assert (json5_value_get_string (&value) == value.chars);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "seven c") == 0);
+
+	// type, length and payload fit into 16 bytes
+	assert (sizeof (void *) != 8 || sizeof (value) == 16);
+
+	json5_value_set_string (&value, "", 0);
+	assert (value.len == 0);
+	assert (strcmp ((char const *) json5_value_get_string (&value), "") == 0);
 
 	item = json5_value_append_item (&value);
 	assert (item == NULL);